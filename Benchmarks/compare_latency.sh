@@ -0,0 +1,49 @@
+#!/bin/bash
+# Before/after comparison of the NMPC computation time of both examples between two versions of the repository
+# Usage: Benchmarks/compare_latency.sh base_ref [head_ref] [instrument_ref]
+# Both versions are built in temporary git worktrees and the examples run from their Examples folders. The examples print their
+# computation time per sample; for a base version before this printout, instrument_ref takes the example sources from another version
+# (e.g. the first persistent solver commit for the Opti baseline). If both versions have nmpc_bench, it is run as well, and the
+# head benchmark is compared with the base benchmark (hessian modes, cold and warm solve latency)
+set -e
+
+if [ $# -lt 1 ]; then
+    echo "Usage: Benchmarks/compare_latency.sh base_ref [head_ref] [instrument_ref]" >&2
+    exit 1
+fi
+base_ref=$1
+head_ref=${2:-HEAD}
+instrument_ref=$3
+repo=$(git rev-parse --show-toplevel)
+work=$(mktemp -d)
+trap 'git -C "$repo" worktree remove --force "$work/base" 2>/dev/null; git -C "$repo" worktree remove --force "$work/head" 2>/dev/null; rm -rf "$work"' EXIT
+
+# Build the examples (and the benchmark, if available) of one version
+build() {
+    git -C "$repo" worktree add --detach "$work/$1" "$2" >/dev/null
+    if [ -n "$3" ]; then
+        git -C "$work/$1" checkout "$3" -- Examples/CSTR/main_cstr.cpp Examples/DIPC/main_dipc.cpp
+    fi
+    cmake -S "$work/$1" -B "$work/$1/build" -DCMAKE_BUILD_TYPE=Release >/dev/null
+    cmake --build "$work/$1/build" -j"$(nproc)" --target nmpc_cstr nmpc_dipc
+    cmake --build "$work/$1/build" -j"$(nproc)" --target nmpc_bench 2>/dev/null || true
+}
+
+# Run both examples of one version and print their computation time
+run() {
+    cd "$work/$1/Examples"
+    echo "== $1 ($(git rev-parse --short HEAD)) CSTR"
+    ./CSTR/nmpc_cstr CSTR/config.yaml CSTR/model_nmpc.yaml CSTR/model_sim.yaml | grep -i "computation time\|deadline"
+    echo "== $1 ($(git rev-parse --short HEAD)) DIPC"
+    ./DIPC/nmpc_dipc DIPC/config.yaml DIPC/model_nmpc.yaml DIPC/model_sim.yaml | grep -i "computation time\|deadline"
+}
+
+build base "$base_ref" "$instrument_ref"
+build head "$head_ref"
+run base
+run head
+
+if [ -x "$work/base/Benchmarks/nmpc_bench" ] && [ -x "$work/head/Benchmarks/nmpc_bench" ]; then
+    (cd "$work/base/Examples" && ../Benchmarks/nmpc_bench . "$work/base.json" 10 >/dev/null)
+    (cd "$work/head/Examples" && ../Benchmarks/nmpc_bench . "$work/head.json" 10 "$work/base.json") || true
+fi
@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+#include "IntegratorRK4.h"
+#include "IntergratorEulerF.h"
+#include "ModelCSTR.h"
+#include "ModelDIPC.h"
+#include "NativeSimulator.h"
+#include "NativeVector.h"
+#include "NonlinearModelPredictiveControl.h"
+
+using namespace std;
+using namespace casadi;
+using namespace nmpc;
+
+// Statistics of one benchmark over its repetitions (times per iteration in seconds)
+struct BenchmarkResult
+{
+    string name;
+    int repetitions;
+    int iterations;
+    double mean;
+    double median;
+    double stddev;
+    double min;
+    double max;
+};
+
+// Keeps the benchmarked results alive, so the compiler cannot remove the computations
+static volatile double sink;
+
+// Run the benchmark function n_iter times per repetition (after one warm-up repetition)
+// The setup function is called before every repetition and is not timed
+BenchmarkResult Run(const string &name, int n_rep, int n_iter, const function<void()> &benchmark, const function<void()> &setup = [] {})
+{
+    vector<double> t(n_rep);
+    for (int r = -1; r < n_rep; r++)
+    {
+        setup();
+        const auto t_start = chrono::steady_clock::now();
+        for (int i = 0; i < n_iter; i++)
+        {
+            benchmark();
+        }
+        if (r >= 0)
+        {
+            t[r] = chrono::duration<double>(chrono::steady_clock::now() - t_start).count() / n_iter;
+        }
+    }
+
+    BenchmarkResult result{name, n_rep, n_iter};
+    vector<double> t_sorted{t};
+    sort(t_sorted.begin(), t_sorted.end());
+    result.mean = accumulate(t.begin(), t.end(), 0.0) / n_rep;
+    result.median = n_rep % 2 ? t_sorted[n_rep / 2] : 0.5 * (t_sorted[n_rep / 2 - 1] + t_sorted[n_rep / 2]);
+    double var{0};
+    for (double t_r : t)
+    {
+        var += (t_r - result.mean) * (t_r - result.mean);
+    }
+    result.stddev = n_rep > 1 ? sqrt(var / (n_rep - 1)) : 0;
+    result.min = t_sorted.front();
+    result.max = t_sorted.back();
+    cout << name << ": median " << 1e6 * result.median << " us (min " << 1e6 * result.min << " us, max " << 1e6 * result.max << " us)" << endl;
+    return result;
+}
+
+// Times per solver iteration of a solve benchmark with n_iter solver iterations
+BenchmarkResult PerIteration(BenchmarkResult result, int n_iter)
+{
+    const double scale{1.0 / max(n_iter, 1)};
+    result.name += "/per_iteration";
+    result.mean *= scale;
+    result.median *= scale;
+    result.stddev *= scale;
+    result.min *= scale;
+    result.max *= scale;
+    cout << result.name << ": median " << 1e6 * result.median << " us (" << n_iter << " iterations)" << endl;
+    return result;
+}
+
+// Copy of the config file with a modified number of shooting intervals and Hessian and without code generation and cache (so the build time is the OCP construction only)
+string WriteConfig(const string &config_file, const string &bench_config_file, int n_shoot, const string &hessian = "exact")
+{
+    YAML::Node config = YAML::LoadFile(config_file);
+    config["ocp.n_shoot"] = n_shoot;
+    config["ocp.hessian"] = hessian;
+    config["ocp.codegen.enable"] = false;
+    config["ocp.cache.enable"] = false;
+    ofstream file(bench_config_file);
+    file << config << endl;
+    return bench_config_file;
+}
+
+// Model and integrator benchmarks of one model on casadi::DM, casadi::MX (as casadi function) and native doubles
+template <template <typename> class Model, int N>
+void BenchmarkModel(const string &name, const string &model_file, const DM &x, const DM &u, int n_rep, vector<BenchmarkResult> &results)
+{
+    const Model<DM> model_dm{model_file};
+    const Model<MX> model_mx{model_file};
+    const Model<NativeVector<N>> model_native{model_file};
+    const IntegratorRK4<DM> rk4_dm;
+    const IntegratorRK4<NativeVector<N>> rk4_native;
+    const IntegratorEulerF<DM> euler_dm;
+    const IntegratorEulerF<NativeVector<N>> euler_native;
+    const IntegratorRK4<MX> rk4_mx;
+
+    const MX x_mx{MX::sym("x", x.size1())};
+    const MX u_mx{MX::sym("u", u.size1())};
+    const Function f{"f", {x_mx, u_mx}, {model_mx(x_mx, u_mx)}};
+    const Function F{"F", {x_mx, u_mx}, {rk4_mx(model_mx, 1e-3, x_mx, u_mx)}};
+    const NativeVector<N> x_native{vector<double>(x)};
+    const NativeVector<N> u_native{vector<double>(u)};
+    const vector<DM> args{x, u};
+
+    results.push_back(Run("model/" + name + "/DM", n_rep, 1000, [&] { sink = model_dm(x, u).nonzeros()[0]; }));
+    results.push_back(Run("model/" + name + "/MX_function", n_rep, 1000, [&] { sink = f(args)[0].nonzeros()[0]; }));
+    results.push_back(Run("model/" + name + "/native", n_rep, 100000, [&] { sink = model_native(x_native, u_native)(0); }));
+    results.push_back(Run("integrator/" + name + "/rk4/DM", n_rep, 1000, [&] { sink = rk4_dm(model_dm, 1e-3, x, u).nonzeros()[0]; }));
+    results.push_back(Run("integrator/" + name + "/rk4/MX_function", n_rep, 1000, [&] { sink = F(args)[0].nonzeros()[0]; }));
+    results.push_back(Run("integrator/" + name + "/rk4/native", n_rep, 100000, [&] { sink = rk4_native(model_native, 1e-3, x_native, u_native)(0); }));
+    results.push_back(Run("integrator/" + name + "/euler/DM", n_rep, 1000, [&] { sink = euler_dm(model_dm, 1e-3, x, u).nonzeros()[0]; }));
+    results.push_back(Run("integrator/" + name + "/euler/native", n_rep, 100000, [&] { sink = euler_native(model_native, 1e-3, x_native, u_native)(0); }));
+}
+
+// OCP construction time versus the number of shooting intervals and cold/warm solve latency of one example
+template <template <typename> class Model, int N>
+void BenchmarkOCP(const string &name, const string &config_file, const string &model_file, const vector<int> &n_shoot, int n_rep, vector<BenchmarkResult> &results)
+{
+    const Model<MX> model{model_file};
+    const Model<NativeVector<N>> sim_model{model_file};
+    const IntegratorRK4<MX> integrator;
+    const IntegratorRK4<NativeVector<N>> sim_integrator;
+    const string bench_config_file{"nmpc_bench_" + name + ".yaml"};
+
+    for (int n : n_shoot)
+    {
+        WriteConfig(config_file, bench_config_file, n);
+        results.push_back(Run("ocp/" + name + "/build/n_shoot:" + to_string(n), n_rep, 1, [&] {
+            const OptimalControlProblem ocp{bench_config_file, model, integrator};
+        }));
+    }
+
+    // Cold solve time per NLP iteration with the exact, the Gauss-Newton and the limited-memory Hessian (horizon of the example)
+    const int n_shoot_example{YAML::LoadFile(config_file)["ocp.n_shoot"].as<int>()};
+    for (const string hessian : {"exact", "gauss_newton", "limited_memory"})
+    {
+        WriteConfig(config_file, bench_config_file, n_shoot_example, hessian);
+        NonlinearModelPredictiveControl nmpc{bench_config_file, model, integrator};
+        BenchmarkResult result{Run("ocp/" + name + "/solve/hessian:" + hessian, n_rep, 1, [&] { sink = nmpc.ComputeControlInput().nonzeros()[0]; }, [&] { nmpc.Reset(nmpc.x_0()); })};
+        results.push_back(result);
+        results.push_back(PerIteration(result, nmpc.stats().iter_count));
+    }
+
+    // Solve latency with the example config (including its code generation)
+    NonlinearModelPredictiveControl nmpc{config_file, model, integrator};
+    const NativeSimulator<N> sim{config_file, sim_model, sim_integrator};
+    results.push_back(Run("ocp/" + name + "/solve/cold", n_rep, 1, [&] { sink = nmpc.ComputeControlInput().nonzeros()[0]; }, [&] { nmpc.Reset(nmpc.x_0()); }));
+
+    // Warm solves along the closed-loop trajectory
+    NativeVector<N> x{vector<double>(nmpc.x_0())};
+    nmpc.Reset(nmpc.x_0());
+    results.push_back(Run("ocp/" + name + "/solve/warm", n_rep, 1, [&] {
+        const DM u{nmpc.ComputeControlInput()};
+        sink = u.nonzeros()[0];
+        x = sim.ApplyControlForTimeStep(x, NativeVector<N>{vector<double>(u)});
+        nmpc.SetInitialCondition(vector<double>(x));
+    }));
+}
+
+void WriteJSON(const string &file_name, const vector<BenchmarkResult> &results)
+{
+    ofstream file(file_name);
+    const time_t now{time(nullptr)};
+    char date[32];
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+    file << "{\n  \"context\": {\"date\": \"" << date << "\", \"compiler\": \"" << __VERSION__ << "\", \"time_unit\": \"s\"},\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchmarkResult &r{results[i]};
+        file << (i > 0 ? ",\n    " : "\n    ") << "{\"name\": \"" << r.name << "\", \"repetitions\": " << r.repetitions << ", \"iterations\": " << r.iterations
+             << ", \"mean\": " << r.mean << ", \"median\": " << r.median << ", \"stddev\": " << r.stddev << ", \"min\": " << r.min << ", \"max\": " << r.max << "}";
+    }
+    file << "\n  ]\n}\n";
+}
+
+// Compare the medians with a JSON file of a previous run (e.g. of the baseline version) and print the ratio of each common benchmark
+// Returns the number of benchmarks, which are slower than the baseline by more than the tolerance (relative to the median)
+int CompareJSON(const string &baseline_file, const vector<BenchmarkResult> &results, double tol)
+{
+    // The JSON output is valid YAML
+    const YAML::Node baseline = YAML::LoadFile(baseline_file)["benchmarks"];
+    int n_slower{0};
+    cout << "Comparison with " << baseline_file << " (median, current / baseline):" << endl;
+    for (const BenchmarkResult &r : results)
+    {
+        for (const YAML::Node &b : baseline)
+        {
+            if (b["name"].as<string>() == r.name)
+            {
+                const double ratio{r.median / b["median"].as<double>()};
+                const bool slower{ratio > 1 + tol};
+                n_slower += slower;
+                cout << "  " << r.name << ": " << ratio << (slower ? " (slower)" : "") << endl;
+            }
+        }
+    }
+    return n_slower;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || argc > 5)
+    {
+        cerr << "Usage: ./nmpc_bench path_to_examples [output_json] [repetitions] [baseline_json]" << endl;
+        return EXIT_FAILURE;
+    }
+
+    const string examples_dir{argv[1]};
+    const string output_file{argc > 2 ? argv[2] : "nmpc_bench.json"};
+    const int n_rep{argc > 3 ? stoi(argv[3]) : 10};
+    vector<BenchmarkResult> results;
+
+    const DM x_cstr{vector<double>{1.0, 0.5, 100.0, 100.0}};
+    const DM u_cstr{vector<double>{14.0, -1000.0}};
+    const DM x_dipc{vector<double>{0.1, 0.5, 0.5, 0.1, 0.1, 0.1}};
+    const DM u_dipc{vector<double>{1.0}};
+    BenchmarkModel<ModelCSTR, 4>("CSTR", examples_dir + "/CSTR/model_nmpc.yaml", x_cstr, u_cstr, n_rep, results);
+    BenchmarkModel<ModelDIPC, 6>("DIPC", examples_dir + "/DIPC/model_nmpc.yaml", x_dipc, u_dipc, n_rep, results);
+
+    const vector<int> n_shoot{10, 25, 50, 100};
+    BenchmarkOCP<ModelCSTR, 4>("CSTR", examples_dir + "/CSTR/config.yaml", examples_dir + "/CSTR/model_nmpc.yaml", n_shoot, n_rep, results);
+    BenchmarkOCP<ModelDIPC, 6>("DIPC", examples_dir + "/DIPC/config.yaml", examples_dir + "/DIPC/model_nmpc.yaml", n_shoot, n_rep, results);
+
+    WriteJSON(output_file, results);
+    cout << "Results written to " << output_file << endl;
+
+    // A regression is a median more than 10 % above the baseline
+    if (argc > 4 && CompareJSON(argv[4], results, 0.1) > 0)
+    {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
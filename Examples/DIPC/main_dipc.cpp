@@ -1,10 +1,12 @@
 #include <array>
+#include <cmath>
 #include <iostream>
 #include "IntegratorRK4.h"
 #include "ModelDIPC.h"
+#include "NativeSimulator.h"
+#include "NativeVector.h"
 #include "NonlinearModelPredictiveControl.h"
-#include "Plot.h"
-#include "Simulator.h"
+#include "TrajectoryRecorder.h"
 
 using namespace std;
 using namespace casadi;
@@ -13,9 +15,9 @@ using namespace nmpc;
 int main(int argc, char **argv)
 {
 
-    if (argc != 4)
+    if (argc != 4 && !(argc == 5 && string(argv[4]) == "--codegen-only"))
     {
-        cerr << "Usage: ./nmpc_main path_to_config path_to_nmpc_model path_to_sim_model " << endl;
+        cerr << "Usage: ./nmpc_main path_to_config path_to_nmpc_model path_to_sim_model [--codegen-only]" << endl;
         return EXIT_FAILURE;
     }
 
@@ -26,48 +28,65 @@ int main(int argc, char **argv)
 
     // Initialize NMPC and simulator
     const ModelDIPC<MX> nmpc_model{nmpc_model_file};
-    const ModelDIPC<DM> sim_model{sim_model_file};
+    const ModelDIPC<NativeVector<6>> sim_model{sim_model_file};
     const IntegratorRK4<MX> nmpc_integrator;
-    const IntegratorRK4<DM> sim_integrator;
+    const IntegratorRK4<NativeVector<6>> sim_integrator;
     NonlinearModelPredictiveControl nmpc{config_file, nmpc_model, nmpc_integrator};
-    const Simulator sim{config_file, sim_model, sim_integrator};
+    const NativeSimulator<6> sim{config_file, sim_model, sim_integrator};
+    if (argc == 5)
+    {
+        // Only build the OCP (and its generated code)
+        return EXIT_SUCCESS;
+    }
 
-    // Start simulation
+    // Start simulation, the trajectories are streamed to the recorder file (plots and CSV via the offline tool nmpc_plot)
     const int N{static_cast<int>((sim.tf() - sim.t0()) / sim.dt())};
-    DM t{DM::zeros(1, N + 1)};
-    DM x{DM::zeros(nmpc.nx(), N + 1)};
-    DM u{DM::zeros(nmpc.nu(), N)};
-    Slice all;
-    t(0) = sim.t0();
-    x(all, 0) = nmpc.x_0();
+    vector<string> columns{"t"};
+    for (int c = 0; c < nmpc.nx(); ++c)
+    {
+        columns.push_back("x_" + to_string(c));
+    }
+    for (int c = 0; c < nmpc.nu(); ++c)
+    {
+        columns.push_back("u_" + to_string(c));
+    }
+    columns.insert(columns.end(), {"t_nmpc", "iter_count", "constr_viol"});
+    TrajectoryRecorder recorder{config_file, "DIPC_trajectory.bin", columns};
+    NativeVector<6> x_k{vector<double>(nmpc.x_0())};
+    vector<double> record;
     for (int k = 0; k < N; k++)
     {
-        t(k + 1) = (k + 1) * sim.dt();
         // Get control input for time step k from NMPC
-        u(all, k) = nmpc.ComputeControlInput();
+        const vector<double> u_k = vector<double>(nmpc.ComputeControlInput());
+        // Record time, state, control and telemetry of time step k
+        const SampleTelemetry sample{nmpc.telemetry().last()};
+        record.assign(1, sim.t0() + k * sim.dt());
+        record.insert(record.end(), x_k.data(), x_k.data() + x_k.size());
+        record.insert(record.end(), u_k.begin(), u_k.end());
+        record.insert(record.end(), {sample.t_init_wall + sample.t_solve_wall + sample.t_extract_wall, static_cast<double>(sample.iter_count), sample.constr_viol});
+        recorder.Append(record);
         // Simulate time step (apply control input for timestep k)
-        x(all, k + 1) = sim.ApplyControlForTimeStep(x(all, k), u(all, k));
+        x_k = sim.ApplyControlForTimeStep(x_k, NativeVector<6>{u_k});
         // Reinitialize NMPC with measured state from simulator
-        nmpc.SetInitialCondition(x(all, k + 1));
-    }
-
-    // Plot simulated state results
-    for (int c = 0; c < x.size(1); ++c)
-    {
-        const string state_name{"x_" + to_string(c)};
-        const string file_name{"DIPC_" + state_name + ".png"};
-        const string title{"Simulated state " + state_name + " over time"};
-        Plot(file_name, title, "t", vector<double>(t(0, all)), state_name, vector<double>(x(c, all)));
+        nmpc.SetInitialCondition(vector<double>(x_k));
     }
+    // Final state (without control)
+    record.assign(1, sim.t0() + N * sim.dt());
+    record.insert(record.end(), x_k.data(), x_k.data() + x_k.size());
+    record.resize(columns.size(), NAN);
+    recorder.Append(record);
 
-    // Plot simulated control results
-    for (int c = 0; c < u.size(1); ++c)
+    // Export the solver telemetry
+    const SolverTelemetry &telemetry{nmpc.telemetry()};
+    const LatencyPercentiles latency{telemetry.Latency()};
+    cout << "NMPC computation time per sample: p50 " << 1e3 * latency.p50 << " ms, p95 " << 1e3 * latency.p95 << " ms, p99 " << 1e3 * latency.p99
+         << " ms, max " << 1e3 * latency.max << " ms" << endl;
+    if (telemetry.deadline() > 0)
     {
-        const string control_name{"u_" + to_string(c)};
-        const string file_name{"DIPC_" + control_name + ".png"};
-        const string title{"Simulated control " + control_name + " over time"};
-        Plot(file_name, title, "t", vector<double>(t(Slice(0, t.size(2) - 1))), control_name, vector<double>(u(c, all)));
+        cout << "NMPC deadline misses: " << telemetry.deadline_misses() << " of " << telemetry.n_samples() << " samples" << endl;
     }
+    telemetry.WriteCSV("DIPC_telemetry.csv");
+    telemetry.WriteJSON("DIPC_telemetry.json");
 
     return EXIT_SUCCESS;
 }
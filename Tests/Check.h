@@ -0,0 +1,57 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace nmpc
+{
+    namespace test
+    {
+        // Number of failed checks of the test executable
+        inline int &n_failed()
+        {
+            static int n{0};
+            return n;
+        }
+
+        // Check a condition and report it if it fails
+        inline void Check(bool condition, const std::string &what)
+        {
+            if (!condition)
+            {
+                std::cerr << "FAILED: " << what << std::endl;
+                n_failed()++;
+            }
+        }
+
+        // Check that two vectors have the same size and agree elementwise within the absolute tolerance
+        inline void CheckNear(const std::vector<double> &a, const std::vector<double> &b, double tol, const std::string &what)
+        {
+            double err{a.size() == b.size() ? 0 : INFINITY};
+            for (std::size_t i = 0; i < std::min(a.size(), b.size()); i++)
+            {
+                err = std::max(err, std::fabs(a[i] - b[i]));
+            }
+            if (!(err <= tol))
+            {
+                std::cerr << "FAILED: " << what << " (maximum deviation " << err << ", tolerance " << tol << ")" << std::endl;
+                n_failed()++;
+            }
+        }
+
+        // Exit code of the test executable
+        inline int Result()
+        {
+            if (n_failed() > 0)
+            {
+                std::cerr << n_failed() << " checks failed" << std::endl;
+                return EXIT_FAILURE;
+            }
+            return EXIT_SUCCESS;
+        }
+    } // namespace test
+} // namespace nmpc
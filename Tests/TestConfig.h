@@ -0,0 +1,31 @@
+#pragma once
+
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <yaml-cpp/yaml.h>
+
+namespace nmpc
+{
+    namespace test
+    {
+        // Write a copy of the config file, in which the entries are replaced by the values (YAML syntax, e.g. "riccati" or "[0.1, 0.1]"),
+        // and return the name of the copy
+        inline std::string WriteConfig(const std::string &config_file, const std::string &test_config_file, const std::map<std::string, std::string> &entries)
+        {
+            YAML::Node config = YAML::LoadFile(config_file);
+            for (const auto &entry : entries)
+            {
+                config[entry.first] = YAML::Load(entry.second);
+            }
+            std::ofstream file(test_config_file);
+            file << config << std::endl;
+            if (!file)
+            {
+                throw std::runtime_error("Cannot write the test config file: " + test_config_file);
+            }
+            return test_config_file;
+        }
+    } // namespace test
+} // namespace nmpc
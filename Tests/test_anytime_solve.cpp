@@ -0,0 +1,75 @@
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+#include <casadi/casadi.hpp>
+#include "Check.h"
+#include "IntegratorRK4.h"
+#include "ModelCSTR.h"
+#include "OptimalControlProblem.h"
+#include "TestConfig.h"
+
+using casadi::DM;
+using casadi::MX;
+using std::map;
+using std::string;
+using std::vector;
+using namespace nmpc;
+using namespace nmpc::test;
+
+namespace
+{
+    // Controls of the cold start of the CSTR config: half of the control ranges for all intervals (OptimalControlProblem::Reset)
+    vector<double> ColdStartControls(int n_shoot)
+    {
+        vector<double> U;
+        for (int k = 0; k < n_shoot; k++)
+        {
+            U.push_back(0.5 * (35 - 3));
+            U.push_back(0.5 * (0 + 9000));
+        }
+        return U;
+    }
+
+    // Solve the OCP of a variant of the CSTR config (Riccati SQP) once from the cold start
+    DM Solve(const map<string, string> &entries, const string &file, const ModelBase<MX> &model, const Integrator<MX> &integrator, SolverStats &stats)
+    {
+        map<string, string> config{{"ocp.solver", "riccati"}, {"ocp.r", "[0.1, 0.1]"}};
+        config.insert(entries.begin(), entries.end());
+        OptimalControlProblem ocp{WriteConfig("CSTR/config.yaml", file, config), model, integrator};
+        const DM U{ocp.Solve()};
+        stats = ocp.stats();
+        std::remove(file.c_str());
+        return U;
+    }
+} // namespace
+
+int main()
+{
+    const ModelCSTR<MX> model{"CSTR/model_nmpc.yaml"};
+    const IntegratorRK4<MX> integrator;
+    const int n_shoot{50};
+    SolverStats stats;
+
+    // Without a feasible iterate (the shooting gaps of the cold start are open), the stopped solve falls back to the previous
+    // control trajectory shifted by one interval, which is the cold start itself
+    const DM U_fallback{Solve({{"ocp.sqp.max_iter", "1"}}, "test_anytime_fallback.yaml", model, integrator, stats)};
+    Check(stats.source == ControlSource::Fallback && !stats.success, "fallback without a feasible iterate");
+    Check(stats.return_status == "Maximum_Iterations_Exceeded" && stats.iter_count == 1, "status of the stopped solve");
+    CheckNear(static_cast<vector<double>>(U_fallback), ColdStartControls(n_shoot), 1e-9, "fallback controls");
+
+    // A feasible iterate is returned instead of the fallback: the solve stopped after two iterations returns the iterate before
+    // the last step, which is the solution after one step
+    const DM U_feasible{Solve({{"ocp.sqp.max_iter", "2"}, {"ocp.budget.feas_tol", "1e10"}}, "test_anytime_feasible.yaml", model, integrator, stats)};
+    Check(stats.source == ControlSource::FeasibleIterate && !stats.success, "feasible iterate of the stopped solve");
+    const DM U_step{Solve({{"ocp.sqp.max_iter", "1"}, {"ocp.sqp.tol", "1e10"}}, "test_anytime_step.yaml", model, integrator, stats)};
+    Check(stats.source == ControlSource::Solution && stats.success, "converged solve");
+    CheckNear(static_cast<vector<double>>(U_feasible), static_cast<vector<double>>(U_step), 1e-9, "feasible iterate is the iterate before the last step");
+
+    // The time budget stops the solve after the first iteration (no iteration is faster than the budget) with its feasible iterate
+    const DM U_budget{Solve({{"ocp.budget.time", "1e-12"}, {"ocp.budget.feas_tol", "1e10"}}, "test_anytime_budget.yaml", model, integrator, stats)};
+    Check(stats.return_status == "Maximum_WallTime_Exceeded" && stats.iter_count == 1, "status of the solve stopped by the time budget");
+    Check(stats.source == ControlSource::FeasibleIterate, "feasible iterate of the solve stopped by the time budget");
+    CheckNear(static_cast<vector<double>>(U_budget), ColdStartControls(n_shoot), 1e-9, "controls of the solve stopped by the time budget");
+    return Result();
+}
@@ -0,0 +1,75 @@
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <casadi/casadi.hpp>
+#include "Check.h"
+#include "IntegratorRK4.h"
+#include "ModelCSTR.h"
+#include "NativeSimulator.h"
+#include "NativeVector.h"
+#include "Simulator.h"
+
+using casadi::DM;
+using std::vector;
+using namespace nmpc;
+using namespace nmpc::test;
+
+namespace
+{
+    // Check that a batch simulation throws std::invalid_argument
+    template <typename F>
+    void CheckThrows(F simulate, const std::string &what)
+    {
+        bool thrown{false};
+        try
+        {
+            simulate();
+        }
+        catch (const std::invalid_argument &)
+        {
+            thrown = true;
+        }
+        Check(thrown, what);
+    }
+} // namespace
+
+int main()
+{
+    // Batch of the CSTR with perturbed plants on the casadi::DM and the native simulator
+    const ModelCSTR<DM> model_dm{"CSTR/model_sim.yaml"};
+    const ModelCSTR<NativeVector<4>> model_native{"CSTR/model_sim.yaml"};
+    const IntegratorRK4<DM> integrator_dm;
+    const IntegratorRK4<NativeVector<4>> integrator_native;
+    const SimParams sim_params{0, 0.01, 0.002, 3};
+    const Simulator sim_dm{"CSTR/config.yaml", model_dm, integrator_dm};
+    const NativeSimulator<4> sim_native{sim_params, model_native, integrator_native};
+    const int n_steps{5};
+    const int n_batch{4};
+    const DM x_0{repmat(DM(vector<double>{2.14, 1.09, 114.2, 112.9}), 1, n_batch)};
+    const DM u{repmat(DM(vector<double>{14.19, -1113.5}), n_steps, n_batch)};
+    const vector<ModelScaling> scaling{{}, {{"model.k_10", 1.1}}, {{"model.k_10", 0.9}}, {{"model.k_20", 1.2}}};
+    auto factory_dm = [](const ModelScaling &s) { return std::unique_ptr<ModelBase<DM>>(new ModelCSTR<DM>("CSTR/model_sim.yaml", s)); };
+    auto factory_native = [](const ModelScaling &s) {
+        return std::unique_ptr<ModelBase<NativeVector<4>>>(new ModelCSTR<NativeVector<4>>("CSTR/model_sim.yaml", s));
+    };
+    Check(sim_dm.dt() == sim_params.dt, "step size of the CSTR config");
+    const vector<double> x_dm{sim_dm.SimulateBatch(x_0, u, n_steps, scaling, factory_dm)};
+    const vector<double> x_native{sim_native.SimulateBatch(x_0, u, n_steps, scaling, factory_native)};
+    Check(x_dm.size() == static_cast<std::size_t>(n_batch * (n_steps + 1) * 4), "size of the batch trajectories");
+    CheckNear(x_native, x_dm, 1e-9, "native batch simulation equals the casadi::DM batch simulation");
+    // Sample 0 is the nominal plant, the perturbed plants deviate from it
+    const vector<double> x_nominal{sim_dm.SimulateBatch(x_0, u, n_steps)};
+    CheckNear(vector<double>(x_dm.begin(), x_dm.begin() + (n_steps + 1) * 4), vector<double>(x_nominal.begin(), x_nominal.begin() + (n_steps + 1) * 4), 1e-12,
+              "unscaled sample equals the nominal plant");
+    Check(x_dm[2 * (n_steps + 1) * 4 - 4] != x_nominal[2 * (n_steps + 1) * 4 - 4], "scaled sample differs from the nominal plant");
+
+    // Invalid dimensions and a scaling without a model factory
+    CheckThrows([&] { sim_dm.SimulateBatch(x_0, u, 0); }, "batch simulation without steps throws");
+    CheckThrows([&] { sim_dm.SimulateBatch(x_0, u, 3); }, "control sequences of the wrong length throw");
+    CheckThrows([&] { sim_dm.SimulateBatch(x_0, u, n_steps, vector<ModelScaling>(2)); }, "wrong number of scalings throws");
+    CheckThrows([&] { sim_dm.SimulateBatch(x_0, u, n_steps, scaling); }, "scaling without a model factory throws");
+    CheckThrows([&] { sim_native.SimulateBatch(x_0, u, n_steps, scaling); }, "native scaling without a model factory throws");
+
+    return Result();
+}
@@ -0,0 +1,113 @@
+#include <cmath>
+#include <string>
+#include <vector>
+#include <casadi/casadi.hpp>
+#include "Check.h"
+#include "Collocation.h"
+
+using std::string;
+using std::vector;
+using namespace nmpc;
+using namespace nmpc::test;
+
+namespace
+{
+    // Polynomial with the coefficients a (ascending powers) and its derivative
+    double Polynomial(const vector<double> &a, double t)
+    {
+        double p{0};
+        for (std::size_t k = a.size(); k-- > 0;)
+        {
+            p = p * t + a[k];
+        }
+        return p;
+    }
+
+    double PolynomialDerivative(const vector<double> &a, double t)
+    {
+        double dp{0};
+        for (std::size_t k = a.size(); k-- > 1;)
+        {
+            dp = dp * t + k * a[k];
+        }
+        return dp;
+    }
+
+    // The collocation polynomial reproduces every polynomial of degree d: its derivatives at the points and its value at the end of the interval
+    void CheckPolynomials(const string &scheme, int d)
+    {
+        vector<double> tau{0};
+        const vector<double> tau_c{casadi::collocation_points(d, scheme)};
+        tau.insert(tau.end(), tau_c.begin(), tau_c.end());
+        vector<double> C;
+        vector<double> D;
+        CollocationCoefficients(tau, C, D);
+        for (int degree = 0; degree <= d; degree++)
+        {
+            vector<double> a(degree + 1, 0.0);
+            for (int k = 0; k <= degree; k++)
+            {
+                a[k] = 1.0 + 0.5 * k - 0.25 * k * k;
+            }
+            vector<double> dp;
+            vector<double> dp_ref;
+            double p_end{0};
+            for (int r = 0; r <= d; r++)
+            {
+                double dp_r{0};
+                for (int j = 0; j <= d; j++)
+                {
+                    dp_r += C[j + r * (d + 1)] * Polynomial(a, tau[j]);
+                }
+                dp.push_back(dp_r);
+                dp_ref.push_back(PolynomialDerivative(a, tau[r]));
+                p_end += D[r] * Polynomial(a, tau[r]);
+            }
+            const string what{scheme + " d = " + std::to_string(d) + ", polynomial degree " + std::to_string(degree)};
+            CheckNear(dp, dp_ref, 1e-9, what + ": derivatives at the points");
+            CheckNear({p_end}, {Polynomial(a, 1)}, 1e-11, what + ": value at the end of the interval");
+        }
+    }
+} // namespace
+
+int main()
+{
+    for (const char *scheme : {"legendre", "radau"})
+    {
+        for (int d = 1; d <= 5; d++)
+        {
+            CheckPolynomials(scheme, d);
+        }
+    }
+
+    // Radau IIA of order 5 (d = 3): the collocation points are the abscissae of the Butcher tableau, the last point is the end of the interval
+    const double s6{std::sqrt(6.0)};
+    const vector<double> c{(4 - s6) / 10, (4 + s6) / 10, 1};
+    const vector<vector<double>> A{{(88 - 7 * s6) / 360, (296 - 169 * s6) / 1800, (-2 + 3 * s6) / 225},
+                                   {(296 + 169 * s6) / 1800, (88 + 7 * s6) / 360, (-2 - 3 * s6) / 225},
+                                   {(16 - s6) / 36, (16 + s6) / 36, 1.0 / 9}};
+    CheckNear(casadi::collocation_points(3, "radau"), c, 1e-12, "Radau IIA collocation points");
+    vector<double> C;
+    vector<double> D;
+    CollocationCoefficients({0, c[0], c[1], c[2]}, C, D);
+    CheckNear(D, {0, 0, 0, 1}, 1e-12, "Radau IIA: the state at the end of the interval is the state at the last point");
+    // The collocation equations h*f(x_r) = sum_j C(j, r)*x_j are the stage equations x_r = x_0 + h*sum_k A(r, k)*f(x_k) of the
+    // Butcher tableau: the derivative matrix of the collocation points is the inverse of A
+    for (int r = 1; r <= 3; r++)
+    {
+        vector<double> row;
+        vector<double> identity;
+        for (int k = 0; k < 3; k++)
+        {
+            double sum{0};
+            for (int j = 1; j <= 3; j++)
+            {
+                sum += C[j + r * 4] * A[j - 1][k];
+            }
+            row.push_back(sum);
+            identity.push_back(r - 1 == k ? 1 : 0);
+        }
+        CheckNear(row, identity, 1e-10, "Radau IIA: derivative matrix times A, row " + std::to_string(r));
+    }
+    return Result();
+}
@@ -0,0 +1,151 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Check.h"
+#include "ExplicitPolicy.h"
+
+using std::string;
+using std::vector;
+using namespace nmpc;
+using namespace nmpc::test;
+
+namespace
+{
+    const char *file_name{"test_explicit_policy.bin"};
+    const std::uint64_t config_hash{12345};
+    const std::uint64_t model_hash{67890};
+
+    // Grid of the table: x_0 in [0, 2] with 3 points, x_1 in [-1, 1] with 5 points
+    const vector<double> x_min{0, -1};
+    const vector<double> x_max{2, 1};
+    const vector<std::int32_t> n_grid{3, 5};
+
+    // Bilinear controls, which the multilinear interpolation reproduces exactly
+    vector<double> Bilinear(double x_0, double x_1)
+    {
+        return {1 + 2 * x_0 - 3 * x_1 + 0.5 * x_0 * x_1, -x_0 + 4 * x_1};
+    }
+
+    // Write a table in the file format of ExplicitPolicy::Save: magic, config and model hash, dimensions, grid, controls and success flags
+    // of the grid points (first state fastest)
+    void WriteTable(const std::vector<char> &valid, double jump = 0, std::uint64_t hash = config_hash, std::size_t n_truncate = 0)
+    {
+        vector<double> u;
+        for (int k_1 = 0; k_1 < n_grid[1]; k_1++)
+        {
+            for (int k_0 = 0; k_0 < n_grid[0]; k_0++)
+            {
+                const double x_0{x_min[0] + (x_max[0] - x_min[0]) * k_0 / (n_grid[0] - 1)};
+                const double x_1{x_min[1] + (x_max[1] - x_min[1]) * k_1 / (n_grid[1] - 1)};
+                vector<double> u_p{Bilinear(x_0, x_1)};
+                // Step of the first control between the two upper rows of x_1 (e.g. an active set change)
+                u_p[0] += k_1 >= 4 ? jump : 0;
+                u.insert(u.end(), u_p.begin(), u_p.end());
+            }
+        }
+        std::ofstream file(file_name, std::ios::binary);
+        file.write("NMPCEXP2", 8);
+        const std::uint64_t hashes[2] = {hash, model_hash};
+        file.write(reinterpret_cast<const char *>(hashes), sizeof(hashes));
+        const std::int32_t dims[2] = {2, 2};
+        file.write(reinterpret_cast<const char *>(dims), sizeof(dims));
+        file.write(reinterpret_cast<const char *>(n_grid.data()), n_grid.size() * sizeof(std::int32_t));
+        file.write(reinterpret_cast<const char *>(x_min.data()), x_min.size() * sizeof(double));
+        file.write(reinterpret_cast<const char *>(x_max.data()), x_max.size() * sizeof(double));
+        file.write(reinterpret_cast<const char *>(u.data()), u.size() * sizeof(double));
+        file.write(valid.data(), valid.size() - n_truncate);
+    }
+
+    ExplicitPolicyParams Params(double tol)
+    {
+        ExplicitPolicyParams params;
+        params.file = file_name;
+        params.tol = tol;
+        params.config_hash = config_hash;
+        return params;
+    }
+
+    // Check that loading the table throws
+    void CheckLoadThrows(const string &what, std::uint64_t model = model_hash)
+    {
+        bool thrown{false};
+        try
+        {
+            ExplicitPolicy::Load(Params(1), model);
+        }
+        catch (const std::runtime_error &)
+        {
+            thrown = true;
+        }
+        Check(thrown, what);
+    }
+} // namespace
+
+int main()
+{
+    const vector<char> all_valid(15, 1);
+    vector<double> u;
+
+    // Interpolation inside the box reproduces the bilinear controls, also on the grid points and the upper bounds of the box
+    WriteTable(all_valid);
+    const ExplicitPolicy policy{ExplicitPolicy::Load(Params(1), model_hash)};
+    Check(policy.n_points() == 15 && policy.n_valid() == 15, "number of grid points");
+    for (const vector<double> &x : vector<vector<double>>{{0.3, -0.7}, {1.25, 0.1}, {1, 0.5}, {0, -1}, {2, 1}, {1.999, 0.999}})
+    {
+        const string at{" at (" + std::to_string(x[0]) + ", " + std::to_string(x[1]) + ")"};
+        Check(policy.Evaluate(x, u), "evaluation inside the box" + at);
+        CheckNear(u, Bilinear(x[0], x[1]), 1e-12, "interpolated controls" + at);
+    }
+
+    // Outside of the box, for a non-finite state or for a state of another dimension, the policy does not answer (the OCP is solved)
+    for (const vector<double> &x : vector<vector<double>>{{-0.01, 0}, {2.01, 0}, {1, -1.5}, {1, 1.01}, {NAN, 0}, {1, INFINITY}, {1}, {1, 0, 0}})
+    {
+        Check(!policy.Evaluate(x, u), "no answer for the state of dimension " + std::to_string(x.size()) + " starting with " + std::to_string(x[0]));
+    }
+    // An empty policy has no coverage
+    Check(!ExplicitPolicy().Evaluate({1, 0}, u), "no answer of the empty policy");
+
+    // A grid point, which was not solved successfully, invalidates the four cells around it
+    vector<char> valid(all_valid);
+    valid[1 + 3 * 2] = 0;
+    WriteTable(valid);
+    const ExplicitPolicy policy_invalid{ExplicitPolicy::Load(Params(1), model_hash)};
+    Check(policy_invalid.n_valid() == 14, "number of valid grid points");
+    Check(!policy_invalid.Evaluate({0.5, -0.25}, u) && !policy_invalid.Evaluate({1.5, -0.25}, u) &&
+              !policy_invalid.Evaluate({0.5, 0.25}, u) && !policy_invalid.Evaluate({1.5, 0.25}, u),
+          "no answer in the cells of the failed grid point");
+    Check(policy_invalid.Evaluate({0.5, -0.75}, u) && policy_invalid.Evaluate({1.5, 0.75}, u), "answer in the other cells");
+
+    // Quality check: the step of the first control is not resolved by the grid, so the cells across the step do not answer, while the
+    // spread of the smooth cells is within the tolerance relative to the range of the controls
+    WriteTable(all_valid, 100);
+    const ExplicitPolicy policy_jump{ExplicitPolicy::Load(Params(0.5), model_hash)};
+    Check(!policy_jump.Evaluate({1, 0.75}, u), "no answer in the cell across the step");
+    Check(policy_jump.Evaluate({1, -0.75}, u) && policy_jump.Evaluate({1, 0.25}, u), "answer in the smooth cells");
+    const ExplicitPolicy policy_tight{ExplicitPolicy::Load(Params(0.01), model_hash)};
+    Check(!policy_tight.Evaluate({1, -0.75}, u), "no answer for a tolerance below the spread of the cell");
+
+    // Round trip of the serialization
+    WriteTable(all_valid);
+    ExplicitPolicy::Load(Params(1), model_hash).Save(file_name);
+    const ExplicitPolicy policy_saved{ExplicitPolicy::Load(Params(1), model_hash)};
+    Check(policy_saved.Evaluate({1.25, 0.1}, u), "evaluation of the saved table");
+    CheckNear(u, Bilinear(1.25, 0.1), 1e-12, "interpolated controls of the saved table");
+
+    // Tables of another config or model, of another format or incomplete tables are rejected
+    WriteTable(all_valid, 0, config_hash + 1);
+    CheckLoadThrows("table of another config is rejected");
+    WriteTable(all_valid);
+    CheckLoadThrows("table of another model is rejected", model_hash + 1);
+    WriteTable(all_valid, 0, config_hash, 1);
+    CheckLoadThrows("incomplete table is rejected");
+    std::ofstream(file_name, std::ios::binary) << "NMPCEXP1";
+    CheckLoadThrows("table of another format is rejected");
+    std::remove(file_name);
+    CheckLoadThrows("missing table is rejected");
+    return Result();
+}
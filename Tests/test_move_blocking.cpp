@@ -0,0 +1,93 @@
+#include <string>
+#include <vector>
+#include <casadi/casadi.hpp>
+#include "Check.h"
+#include "MoveBlocking.h"
+
+using casadi::DM;
+using casadi::Slice;
+using std::string;
+using std::vector;
+using namespace nmpc;
+using namespace nmpc::test;
+
+namespace
+{
+    // Check the block starts of a pattern, the blocking matrix and the expansion of the block controls to the shooting intervals
+    void CheckBlocking(int n_shoot, int control_horizon, const vector<int> &move_blocking, const vector<int> &block_start_ref, const string &what)
+    {
+        const vector<int> block_start{BlockStarts(n_shoot, control_horizon, move_blocking)};
+        Check(block_start == block_start_ref, what + ": block starts");
+        const int n_blocks{static_cast<int>(block_start.size())};
+
+        // Each interval belongs to exactly one block, the block which starts last before or at the interval
+        const DM T_block{BlockingMatrix(block_start, n_shoot)};
+        Check(T_block.size1() == n_blocks && T_block.size2() == n_shoot, what + ": dimensions of the blocking matrix");
+        const DM T_dense{densify(T_block)};
+        for (int i = 0; i < n_shoot && T_block.size1() == n_blocks && T_block.size2() == n_shoot; i++)
+        {
+            int b_i{0};
+            while (b_i + 1 < n_blocks && block_start[b_i + 1] <= i)
+            {
+                b_i++;
+            }
+            vector<double> column;
+            vector<double> column_ref;
+            for (int b = 0; b < n_blocks; b++)
+            {
+                column.push_back(static_cast<double>(T_dense(b, i)));
+                column_ref.push_back(b == b_i ? 1 : 0);
+            }
+            CheckNear(column, column_ref, 0, what + ": blocking matrix, interval " + std::to_string(i));
+        }
+
+        // NLP variables with nx = 2 states per node, nu = 2 block controls and 3 further variables (e.g. collocation states)
+        const int nx{2};
+        const int nu{2};
+        const int n_x{nx * (n_shoot + 1)};
+        vector<double> w;
+        for (int k = 0; k < n_x; k++)
+        {
+            w.push_back(-1.0 - k);
+        }
+        for (int b = 0; b < n_blocks; b++)
+        {
+            w.push_back(100.0 * b);
+            w.push_back(100.0 * b + 1);
+        }
+        const vector<double> w_tail{0.25, 0.5, 0.75};
+        w.insert(w.end(), w_tail.begin(), w_tail.end());
+        const vector<double> w_full{static_cast<vector<double>>(UnblockControls(DM(w), n_x, nu, T_block))};
+        Check(static_cast<int>(w_full.size()) == n_x + nu * n_shoot + 3, what + ": number of the expanded NLP variables");
+        if (static_cast<int>(w_full.size()) != n_x + nu * n_shoot + 3)
+        {
+            return;
+        }
+        CheckNear(vector<double>(w_full.begin(), w_full.begin() + n_x), vector<double>(w.begin(), w.begin() + n_x), 0, what + ": states");
+        for (int i = 0, b = 0; i < n_shoot; i++)
+        {
+            b = b + 1 < n_blocks && block_start[b + 1] == i ? b + 1 : b;
+            CheckNear({w_full[n_x + nu * i], w_full[n_x + nu * i + 1]}, {100.0 * b, 100.0 * b + 1}, 0,
+                      what + ": controls of interval " + std::to_string(i));
+        }
+        CheckNear(vector<double>(w_full.end() - 3, w_full.end()), w_tail, 0, what + ": further variables");
+    }
+} // namespace
+
+int main()
+{
+    // Without a pattern and control horizon, each interval has its own control and the NLP variables are not expanded
+    CheckBlocking(6, 6, {}, {0, 1, 2, 3, 4, 5}, "no move blocking");
+    // The last length of the pattern is repeated and the last block is cut at the end of the horizon
+    CheckBlocking(10, 10, {1, 1, 2, 4}, {0, 1, 2, 4, 8}, "pattern of lengths");
+    CheckBlocking(10, 10, {3}, {0, 3, 6, 9}, "single length");
+    // The control horizon ends the blocks, the last block is held until the end of the horizon
+    CheckBlocking(10, 4, {}, {0, 1, 2, 3}, "control horizon");
+    CheckBlocking(10, 5, {2}, {0, 2, 4}, "control horizon and single length");
+    // The control horizon is clamped to at least one and at most all intervals
+    CheckBlocking(5, 0, {}, {0}, "control horizon of zero");
+    CheckBlocking(5, 8, {}, {0, 1, 2, 3, 4}, "control horizon beyond the prediction horizon");
+    // Non-positive lengths count as one interval
+    CheckBlocking(4, 4, {0}, {0, 1, 2, 3}, "length of zero");
+    return Result();
+}
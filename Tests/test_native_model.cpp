@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <casadi/casadi.hpp>
+#include "Check.h"
+#include "IntegratorRK4.h"
+#include "IntegratorRK45.h"
+#include "IntergratorEulerF.h"
+#include "ModelCSTR.h"
+#include "ModelDIPC.h"
+#include "NativeVector.h"
+#include "RuntimeParameters.h"
+
+using casadi::DM;
+using casadi::MX;
+using std::string;
+using std::vector;
+using namespace nmpc;
+using namespace nmpc::test;
+
+namespace
+{
+    // Check the result of a native evaluation against the casadi::DM evaluation (relative to the magnitude of the DM result)
+    void CheckEqual(const vector<double> &native, const DM &reference, const string &what)
+    {
+        const vector<double> ref{static_cast<vector<double>>(reference)};
+        double scale{1};
+        for (double r : ref)
+        {
+            scale = std::max(scale, std::fabs(r));
+        }
+        CheckNear(native, ref, 1e-10 * scale, what);
+    }
+
+    // Compare the model equations and the integrator steps on native vectors and on casadi::MX (as casadi function) with casadi::DM
+    template <template <typename> class Model, int N>
+    void CheckModel(const string &name, const string &model_file, const vector<vector<double>> &x, const vector<vector<double>> &u)
+    {
+        using Vector = NativeVector<N>;
+        const Model<DM> model_dm{model_file};
+        const Model<MX> model_mx{model_file};
+        const Model<Vector> model_native{model_file};
+        const IntegratorRK4<DM> rk4_dm;
+        const IntegratorRK4<Vector> rk4_native;
+        const IntegratorEulerF<DM> euler_dm;
+        const IntegratorEulerF<Vector> euler_native;
+        const IntegratorRK45<DM> rk45_dm;
+        const IntegratorRK45<Vector> rk45_native;
+
+        const MX x_mx{MX::sym("x", static_cast<casadi::casadi_int>(x[0].size()))};
+        const MX u_mx{MX::sym("u", static_cast<casadi::casadi_int>(u[0].size()))};
+        const MX theta{RuntimeParameterSymbols(model_mx)};
+        vector<double> theta_val;
+        for (const RuntimeParameter<MX> &param : model_mx.runtime_parameters())
+        {
+            theta_val.push_back(param.value);
+        }
+        const casadi::Function f_mx{"f", {x_mx, u_mx, theta}, {model_mx(x_mx, u_mx)}};
+
+        const double dt{1e-3};
+        for (std::size_t i = 0; i < x.size(); i++)
+        {
+            const string point{name + " at point " + std::to_string(i)};
+            const DM x_dm{x[i]};
+            const DM u_dm{u[i]};
+            const Vector x_native{x[i]};
+            const Vector u_native{u[i]};
+            const DM f_dm{model_dm(x_dm, u_dm)};
+            CheckEqual(static_cast<vector<double>>(model_native(x_native, u_native)), f_dm, "native model equations of " + point);
+            CheckEqual(static_cast<vector<double>>(f_mx(vector<DM>{x_dm, u_dm, DM(theta_val)})[0]), f_dm, "MX model equations of " + point);
+            CheckEqual(static_cast<vector<double>>(rk4_native(model_native, dt, x_native, u_native)), rk4_dm(model_dm, dt, x_dm, u_dm),
+                       "native RK4 step of " + point);
+            CheckEqual(static_cast<vector<double>>(euler_native(model_native, dt, x_native, u_native)), euler_dm(model_dm, dt, x_dm, u_dm),
+                       "native explicit Euler step of " + point);
+            CheckEqual(static_cast<vector<double>>(rk45_native(model_native, dt, x_native, u_native)), rk45_dm(model_dm, dt, x_dm, u_dm),
+                       "native RK45 step of " + point);
+        }
+    }
+} // namespace
+
+int main()
+{
+    // Operating point of the CSTR example and a point near the lower state constraints
+    CheckModel<ModelCSTR, 4>("CSTR", "CSTR/model_nmpc.yaml", {{2.14, 1.09, 114.2, 112.9}, {1.0, 0.5, 100.0, 100.0}}, {{14.19, -1113.5}, {14.0, -1000.0}});
+    // Upright position and deflected pendulums with velocities (state dependent mass matrix)
+    CheckModel<ModelDIPC, 6>("DIPC", "DIPC/model_nmpc.yaml", {{0, 0, 0, 0, 0, 0}, {0.1, 0.5, 0.5, 0.1, 0.1, 0.1}, {-0.3, 0.2, -0.4, 1.0, -2.0, 3.0}},
+                             {{0.0}, {1.0}, {-5.0}});
+    // Pendulum angles over a full revolution, where the off-diagonal entries of the mass matrix change sign (adjugate of the native model)
+    vector<vector<double>> x_angles;
+    vector<vector<double>> u_angles;
+    for (int i = 0; i < 8; i++)
+    {
+        for (int j = 0; j < 8; j++)
+        {
+            x_angles.push_back({0.2, i * M_PI / 4, j * M_PI / 4 + 0.1, 0.5, -1.0, 1.5});
+            u_angles.push_back({2.0});
+        }
+    }
+    CheckModel<ModelDIPC, 6>("DIPC (angles)", "DIPC/model_nmpc.yaml", x_angles, u_angles);
+    return Result();
+}
@@ -0,0 +1,113 @@
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include <casadi/casadi.hpp>
+#include "Check.h"
+#include "IntegratorRK4.h"
+#include "ModelCSTR.h"
+#include "OptimalControlProblem.h"
+#include "TestConfig.h"
+
+using casadi::DM;
+using casadi::MX;
+using std::map;
+using std::string;
+using std::vector;
+using namespace nmpc;
+using namespace nmpc::test;
+
+namespace
+{
+    const string cache_dir{"test_cache"};
+
+    // Files in the cache directory and their inodes (a rewritten file is renamed from a temporary file and gets a new inode)
+    map<string, ino_t> CacheFiles()
+    {
+        map<string, ino_t> files;
+        DIR *dir{opendir(cache_dir.c_str())};
+        if (dir == nullptr)
+        {
+            return files;
+        }
+        while (const dirent *entry = readdir(dir))
+        {
+            struct stat info;
+            const string path{cache_dir + "/" + entry->d_name};
+            if (stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode))
+            {
+                files[path] = info.st_ino;
+            }
+        }
+        closedir(dir);
+        return files;
+    }
+
+    void RemoveCache()
+    {
+        for (const auto &file : CacheFiles())
+        {
+            std::remove(file.first.c_str());
+        }
+        rmdir(cache_dir.c_str());
+    }
+
+    // Build the OCP (loaded from the cache if possible) and solve it from the cold start
+    vector<double> Solve(const string &config_file, const ModelBase<MX> &model, const Integrator<MX> &integrator)
+    {
+        OptimalControlProblem ocp{config_file, model, integrator};
+        return static_cast<vector<double>>(ocp.Solve());
+    }
+} // namespace
+
+int main()
+{
+    const ModelCSTR<MX> model{"CSTR/model_nmpc.yaml"};
+    const IntegratorRK4<MX> integrator;
+    const map<string, string> cache{{"ocp.cache.enable", "true"}, {"ocp.cache.dir", cache_dir}};
+    const string config_file{WriteConfig("CSTR/config.yaml", "test_ocp_cache.yaml", cache)};
+    RemoveCache();
+
+    // The first build writes the cache file, the second one loads it without rewriting it and solves the same NLP
+    const vector<double> U_built{Solve(config_file, model, integrator)};
+    const map<string, ino_t> files{CacheFiles()};
+    Check(files.size() == 1, "cache file of the first build");
+    if (files.size() != 1)
+    {
+        RemoveCache();
+        return Result();
+    }
+    const vector<double> U_cached{Solve(config_file, model, integrator)};
+    Check(CacheFiles() == files, "cache file is loaded, not rewritten");
+    CheckNear(U_cached, U_built, 1e-6, "solution of the cached solver");
+
+    // Another config or another model (the discretized dynamics) are other keys
+    map<string, string> weights{cache};
+    weights["ocp.q"] = "[2]";
+    Solve(WriteConfig("CSTR/config.yaml", "test_ocp_cache_weights.yaml", weights), model, integrator);
+    const map<string, ino_t> files_config{CacheFiles()};
+    Check(files_config.size() == 2 && files_config.count(files.begin()->first) == 1 && files_config.at(files.begin()->first) == files.begin()->second,
+          "new cache file for another config");
+    const ModelCSTR<MX> model_scaled{"CSTR/model_nmpc.yaml", {{"model.k_10", 1.1}}};
+    Solve(config_file, model_scaled, integrator);
+    Check(CacheFiles().size() == 3, "new cache file for another model");
+
+    // A corrupt cache file is not an error: the OCP is rebuilt, solves the same NLP and replaces the file, which is loaded again
+    std::ofstream(files.begin()->first, std::ios::binary | std::ios::trunc) << "corrupt cache file";
+    const vector<double> U_rebuilt{Solve(config_file, model, integrator)};
+    CheckNear(U_rebuilt, U_built, 1e-6, "solution of the OCP rebuilt after a corrupt cache file");
+    const map<string, ino_t> files_rebuilt{CacheFiles()};
+    Check(files_rebuilt.size() == 3 && files_rebuilt.count(files.begin()->first) == 1 && files_rebuilt.at(files.begin()->first) != files.begin()->second,
+          "corrupt cache file is replaced");
+    Solve(config_file, model, integrator);
+    Check(CacheFiles() == files_rebuilt, "replaced cache file is loaded");
+
+    RemoveCache();
+    std::remove("test_ocp_cache.yaml");
+    std::remove("test_ocp_cache_weights.yaml");
+    return Result();
+}
@@ -0,0 +1,91 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Check.h"
+#include "TrajectoryRecorder.h"
+
+using std::string;
+using std::vector;
+using namespace nmpc;
+using namespace nmpc::test;
+
+namespace
+{
+    const char *file_name{"test_recorder.bin"};
+    const vector<string> columns{"t", "x_0", "x_hat_0"};
+
+    // Record r: the last column is missing in every 7th record
+    vector<double> Record(int r)
+    {
+        vector<double> record{0.01 * r, std::sin(0.1 * r), -1.0 * r};
+        if (r % 7 == 0)
+        {
+            record.pop_back();
+        }
+        return record;
+    }
+
+    // Check the records of a trajectory file against the appended records
+    void CheckTrajectory(const Trajectory &trajectory, int n_records, const string &what)
+    {
+        Check(trajectory.columns == columns, what + ": column names");
+        Check(trajectory.data.size() == columns.size() && static_cast<int>(trajectory.data[0].size()) == n_records, what + ": number of records");
+        bool equal{trajectory.data.size() == columns.size()};
+        for (int r = 0; equal && r < static_cast<int>(trajectory.data[0].size()); r++)
+        {
+            const vector<double> record{Record(r)};
+            for (std::size_t c = 0; c < columns.size(); c++)
+            {
+                // Missing values are NaN
+                equal = equal && (c < record.size() ? trajectory.data[c][r] == record[c] : std::isnan(trajectory.data[c][r]));
+            }
+        }
+        Check(equal, what + ": values of the records");
+    }
+} // namespace
+
+int main()
+{
+    // Several blocks (the block size is rounded up to a page) with a fast background flush
+    const RecorderParams params{100, 0.01};
+    const int n_records{2500};
+    {
+        TrajectoryRecorder recorder{params, file_name, columns};
+        Check(recorder.n_columns() == 3, "number of columns");
+        for (int r = 0; r < n_records / 2; r++)
+        {
+            recorder.Append(Record(r));
+        }
+        // Read the file of the running recording after the next flush
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        CheckTrajectory(ReadTrajectory(file_name), n_records / 2, "running recording");
+        for (int r = n_records / 2; r < n_records; r++)
+        {
+            recorder.Append(Record(r));
+        }
+        Check(recorder.n_records() == n_records, "number of appended records");
+        // Read concurrently to the flushes: every flushed prefix is complete
+        const Trajectory partial{ReadTrajectory(file_name)};
+        const int n_partial{static_cast<int>(partial.data.empty() ? 0 : partial.data[0].size())};
+        Check(n_partial >= n_records / 2 && n_partial <= n_records, "flushed prefix of the running recording");
+        CheckTrajectory(partial, n_partial, "flushed prefix of the running recording");
+    }
+    // The destructor flushes all records
+    CheckTrajectory(ReadTrajectory(file_name), n_records, "closed recording");
+    std::remove(file_name);
+
+    bool thrown{false};
+    try
+    {
+        ReadTrajectory(file_name);
+    }
+    catch (const std::runtime_error &)
+    {
+        thrown = true;
+    }
+    Check(thrown, "missing trajectory file throws");
+    return Result();
+}
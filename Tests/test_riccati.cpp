@@ -0,0 +1,127 @@
+#include <cmath>
+#include <vector>
+#include <casadi/casadi.hpp>
+#include "Check.h"
+#include "RiccatiSolver.h"
+
+using casadi::DM;
+using casadi::Slice;
+using std::vector;
+using namespace nmpc;
+using namespace nmpc::test;
+
+namespace
+{
+    const int nx{2};
+    const int nu{1};
+    const int N{10};
+
+    // Stage-wise QP of a discretized double integrator with an affine term in the dynamics and a cross term in the cost
+    vector<RiccatiStage> Stages()
+    {
+        const double h{0.1};
+        vector<RiccatiStage> stages(N + 1);
+        for (int k = 0; k < N; k++)
+        {
+            stages[k].Q = {10, 0, 0, 1};
+            stages[k].S = {0.1, 0};
+            stages[k].R = {0.5};
+            stages[k].q = {0.1, -0.2};
+            stages[k].r = {0.05};
+            stages[k].A = {1, 0, h, 1};
+            stages[k].B = {0.5 * h * h, h};
+            stages[k].c = {0.01, -0.02};
+        }
+        stages[N].Q = {20, 0, 0, 2};
+        stages[N].q = {0, 0.1};
+        return stages;
+    }
+
+    // Dense column-major matrix of the stage data
+    DM Dense(const vector<double> &values, int n_rows, int n_cols)
+    {
+        return reshape(DM(values), n_rows, n_cols);
+    }
+
+    // Dense formulation of the same QP with casadi: hessian H and gradient g of the cost, equality constraints G*w = b
+    // (initial condition and dynamics) for the stacked variables w = [x_0; ...; x_N; u_0; ...; u_N-1]
+    void DenseQP(const vector<RiccatiStage> &stages, const DM &x_0, DM &H, DM &g, DM &G, DM &b)
+    {
+        const int n_x{nx * (N + 1)};
+        const int n_w{n_x + nu * N};
+        H = DM::zeros(n_w, n_w);
+        g = DM::zeros(n_w, 1);
+        G = DM::zeros(nx * (N + 1), n_w);
+        b = DM::zeros(nx * (N + 1), 1);
+        G(Slice(0, nx), Slice(0, nx)) = DM::eye(nx);
+        b(Slice(0, nx)) = x_0;
+        for (int k = 0; k <= N; k++)
+        {
+            const Slice x_k(k * nx, (k + 1) * nx);
+            H(x_k, x_k) = Dense(stages[k].Q, nx, nx);
+            g(x_k) = DM(stages[k].q);
+            if (k == N)
+            {
+                break;
+            }
+            const Slice u_k(n_x + k * nu, n_x + (k + 1) * nu);
+            const Slice x_next((k + 1) * nx, (k + 2) * nx);
+            const DM S{Dense(stages[k].S, nu, nx)};
+            H(u_k, u_k) = Dense(stages[k].R, nu, nu);
+            H(u_k, x_k) = S;
+            H(x_k, u_k) = S.T();
+            g(u_k) = DM(stages[k].r);
+            G(x_next, x_next) = DM::eye(nx);
+            G(x_next, x_k) = -Dense(stages[k].A, nx, nx);
+            G(x_next, u_k) = -Dense(stages[k].B, nx, nu);
+            b(x_next) = DM(stages[k].c);
+        }
+    }
+} // namespace
+
+int main()
+{
+    const vector<RiccatiStage> stages{Stages()};
+    const DM x_0{vector<double>{1.0, 0.5}};
+    const int n_x{nx * (N + 1)};
+    const int n_w{n_x + nu * N};
+    DM H, g, G, b;
+    DenseQP(stages, x_0, H, g, G, b);
+    RiccatiSolver solver(nx, nu, N, RiccatiParams{100, 1e-10});
+
+    // Without bounds: the solution of the KKT system of the equality constrained QP
+    const int n_g{static_cast<int>(G.size1())};
+    const DM KKT{DM::vertcat({DM::horzcat({H, G.T()}), DM::horzcat({G, DM::zeros(n_g, n_g)})})};
+    const DM sol_kkt{solve(KKT, DM::vertcat({-g, b}))};
+    vector<double> lbw(n_w, -INFINITY);
+    vector<double> ubw(n_w, INFINITY);
+    vector<double> w(n_w, 0.0);
+    w[0] = 1.0;
+    w[1] = 0.5;
+    Check(solver.Solve(stages, lbw, ubw, w), "Riccati solver converges without bounds");
+    CheckNear(w, static_cast<vector<double>>(sol_kkt(Slice(0, n_w))), 1e-6, "Riccati solution without bounds equals the dense KKT solution");
+    CheckNear(solver.pi(), static_cast<vector<double>>(-sol_kkt(Slice(n_w + nx, n_w + n_g))), 1e-6, "Riccati multipliers of the dynamics");
+
+    // Bounds of the controls and of the second state, which are active in the solution (the bounds of x_0 are ignored by the solver)
+    for (int k = 0; k < N; k++)
+    {
+        lbw[n_x + k] = -2;
+        ubw[n_x + k] = 2;
+    }
+    for (int k = 1; k <= N; k++)
+    {
+        lbw[k * nx + 1] = -0.3;
+    }
+    casadi::Dict opts;
+    opts["print_iter"] = false;
+    opts["print_header"] = false;
+    const casadi::Function qp{casadi::conic("qp", "qrqp", {{"h", H.sparsity()}, {"a", G.sparsity()}}, opts)};
+    const DM w_qp{qp(casadi::DMDict{{"h", H}, {"g", g}, {"a", G}, {"lba", b}, {"uba", b}, {"lbx", DM(lbw)}, {"ubx", DM(ubw)}}).at("x")};
+    w.assign(n_w, 0.0);
+    w[0] = 1.0;
+    w[1] = 0.5;
+    Check(solver.Solve(stages, lbw, ubw, w), "Riccati solver converges with bounds");
+    CheckNear(w, static_cast<vector<double>>(w_qp), 1e-6, "Riccati solution with active bounds equals the solution of qrqp");
+
+    return Result();
+}
@@ -0,0 +1,124 @@
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <casadi/casadi.hpp>
+#include "Check.h"
+#include "IntegratorRK45.h"
+
+using casadi::DM;
+using casadi::MX;
+using std::vector;
+using namespace nmpc;
+using namespace nmpc::test;
+
+namespace
+{
+    // Linear test equation x_dot = lambda*x
+    template <typename T>
+    class ModelLinear : public ModelBase<T>
+    {
+    public:
+        explicit ModelLinear(double lambda) : lambda_{lambda}
+        {
+        }
+
+        T operator()(const T &x_k, const T &) const override
+        {
+            return lambda_ * x_k;
+        }
+
+    private:
+        double lambda_;
+    };
+
+    // Riccati equation x_dot = u*x^2 with the solution x(t) = x_0/(1 - u*x_0*t)
+    class ModelQuadratic : public ModelBase<DM>
+    {
+    public:
+        DM operator()(const DM &x_k, const DM &u_k) const override
+        {
+            return u_k * x_k * x_k;
+        }
+    };
+
+    // Riccati equation x_dot = x^2, whose model evaluation is not finite above x_max (e.g. overflow in a stiff region)
+    class ModelBlowUp : public ModelBase<DM>
+    {
+    public:
+        explicit ModelBlowUp(double x_max) : x_max_{x_max}
+        {
+        }
+
+        DM operator()(const DM &x_k, const DM &) const override
+        {
+            return static_cast<double>(x_k) > x_max_ ? DM(NAN) : x_k * x_k;
+        }
+
+    private:
+        double x_max_;
+    };
+
+    // Stability function of the 5th order Dormand-Prince solution: one step of the linear test equation multiplies x by R(z), z = h*lambda
+    double StabilityFunction(double z)
+    {
+        return 1 + z + z * z / 2 + std::pow(z, 3) / 6 + std::pow(z, 4) / 24 + std::pow(z, 5) / 120 + std::pow(z, 6) / 600;
+    }
+} // namespace
+
+int main()
+{
+    const double lambda{-1.3};
+    const DM x_0{1.0};
+    const DM u_0{0.0};
+
+    // Single steps (tolerances, which accept the first step over dt) reproduce the stability function of the Butcher tableau
+    const ModelLinear<DM> linear_dm{lambda};
+    const IntegratorRK45<DM> single_step{1e9, 1e9};
+    for (double h : {0.1, 0.5, 1.0})
+    {
+        CheckNear({static_cast<double>(single_step(linear_dm, h, x_0, u_0))}, {StabilityFunction(lambda * h)}, 1e-14,
+                  "Dormand-Prince step of the linear test equation with h = " + std::to_string(h));
+    }
+
+    // Symbolic integration with a fixed step schedule
+    const ModelLinear<MX> linear_mx{lambda};
+    const MX x{MX::sym("x")};
+    const MX u{MX::sym("u")};
+    const IntegratorRK45<MX> one_step;
+    const IntegratorRK45<MX> two_steps{1e-6, 1e-3, {0.5, 0.5}};
+    const casadi::Function F_one{"F_one", {x, u}, {one_step(linear_mx, 1.0, x, u)}};
+    const casadi::Function F_two{"F_two", {x, u}, {two_steps(linear_mx, 1.0, x, u)}};
+    CheckNear({static_cast<double>(F_one(vector<DM>{x_0, u_0})[0])}, {StabilityFunction(lambda)}, 1e-14, "symbolic Dormand-Prince step");
+    CheckNear({static_cast<double>(F_two(vector<DM>{x_0, u_0})[0])}, {std::pow(StabilityFunction(lambda / 2), 2)}, 1e-14,
+              "symbolic Dormand-Prince steps of the schedule");
+
+    // Adaptive integration of a nonlinear equation with tight tolerances, the recorded schedule covers dt
+    const ModelQuadratic quadratic;
+    const IntegratorRK45<DM> adaptive{1e-12, 1e-12};
+    const DM u_1{1.0};
+    CheckNear({static_cast<double>(adaptive(quadratic, 0.5, x_0, u_1))}, {2.0}, 1e-9, "adaptive integration of x_dot = x^2");
+    const vector<double> schedule{adaptive.Schedule(quadratic, 0.5, x_0, u_1)};
+    double sum{0};
+    for (double h : schedule)
+    {
+        sum += h;
+    }
+    Check(schedule.size() > 1 && std::fabs(sum - 1) < 1e-12, "step schedule of the adaptive integration covers dt");
+
+    // Steps with non-finite stages are rejected and retried with a smaller step size, the solution x(0.5) = 2 stays below x_max
+    CheckNear({static_cast<double>(adaptive(ModelBlowUp(3.0), 0.5, x_0, u_1))}, {2.0}, 1e-9, "adaptive integration rejects non-finite steps");
+    // A model, which is not finite at the initial state, fails at the minimum step size instead of looping forever
+    bool thrown{false};
+    try
+    {
+        adaptive(ModelBlowUp(0.0), 0.5, x_0, u_1);
+    }
+    catch (const std::runtime_error &)
+    {
+        thrown = true;
+    }
+    Check(thrown, "adaptive integration of a non-finite model throws");
+
+    return Result();
+}
@@ -0,0 +1,78 @@
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+#include <casadi/casadi.hpp>
+#include "Check.h"
+#include "IntegratorRK4.h"
+#include "ModelCSTR.h"
+#include "OptimalControlProblem.h"
+#include "TestConfig.h"
+
+using casadi::DM;
+using casadi::MX;
+using casadi::Slice;
+using std::map;
+using std::string;
+using std::vector;
+using namespace nmpc;
+using namespace nmpc::test;
+
+namespace
+{
+    // Scaling factors of the controls of the CSTR config
+    const DM sc_u{DM(vector<double>{0.1, 0.0005})};
+
+    // Split of the real-time iteration: the preparation phase does not depend on the measurement, so the feedback phase gives the same
+    // control whether the state was measured before or after the preparation, and it answers to the measurement
+    void CheckSplit(const string &config_file, const ModelBase<MX> &model, const Integrator<MX> &integrator, const string &what)
+    {
+        OptimalControlProblem ocp{config_file, model, integrator};
+        ocp.FeedbackRTI();
+        const DM x_meas{DM(vector<double>{2.1, 1.08, 114.0, 112.9})};
+        OptimalControlProblem ocp_before{ocp};
+        ocp_before.Init(x_meas);
+        ocp_before.PrepareRTI();
+        const DM U_before{ocp_before.FeedbackRTI()};
+        OptimalControlProblem ocp_after{ocp};
+        ocp_after.PrepareRTI();
+        ocp_after.Init(x_meas);
+        const DM U_after{ocp_after.FeedbackRTI()};
+        CheckNear(static_cast<vector<double>>(U_after), static_cast<vector<double>>(U_before), 0, what + ": measurement before and after the preparation phase");
+
+        OptimalControlProblem ocp_other{ocp};
+        ocp_other.PrepareRTI();
+        ocp_other.Init(DM(vector<double>{2.2, 1.0, 113.0, 112.0}));
+        const DM U_other{ocp_other.FeedbackRTI()};
+        Check(static_cast<double>(norm_inf(sc_u * (U_other(Slice(), 0) - U_after(Slice(), 0)))) > 1e-6, what + ": feedback to another measurement");
+    }
+} // namespace
+
+int main()
+{
+    const ModelCSTR<MX> model{"CSTR/model_nmpc.yaml"};
+    const IntegratorRK4<MX> integrator;
+    // Control weights make the Gauss-Newton QPs strictly convex
+    const map<string, string> rti_riccati{{"nmpc.mode", "rti"}, {"ocp.solver", "riccati"}, {"ocp.r", "[0.1, 0.1]"}};
+    const map<string, string> rti_qrqp{{"nmpc.mode", "rti"}, {"ocp.solver", "ipopt"}, {"ocp.rti.qp_solver", "qrqp"}, {"ocp.r", "[0.1, 0.1]"}};
+    CheckSplit(WriteConfig("CSTR/config.yaml", "test_rti_riccati.yaml", rti_riccati), model, integrator, "riccati");
+    CheckSplit(WriteConfig("CSTR/config.yaml", "test_rti_qrqp.yaml", rti_qrqp), model, integrator, "qrqp");
+
+    // The initialization iterations of the real-time iteration are full Gauss-Newton SQP iterations: after convergence, the real-time
+    // iteration answers with the solution of the Riccati SQP of the nlp mode (both stop below the step tolerance 1e-6 of the scaled variables)
+    map<string, string> rti_init{rti_riccati};
+    rti_init["ocp.rti.n_init_iter"] = "100";
+    OptimalControlProblem ocp_rti{WriteConfig("CSTR/config.yaml", "test_rti_init.yaml", rti_init), model, integrator};
+    const DM U_rti{ocp_rti.FeedbackRTI()};
+    OptimalControlProblem ocp_nlp{WriteConfig("CSTR/config.yaml", "test_rti_nlp.yaml", {{"ocp.solver", "riccati"}, {"ocp.sqp.max_iter", "100"}, {"ocp.r", "[0.1, 0.1]"}}),
+                                  model, integrator};
+    const DM U_nlp{ocp_nlp.Solve()};
+    Check(ocp_nlp.stats().success && ocp_rti.stats().success, "convergence of the Riccati SQP");
+    CheckNear(static_cast<vector<double>>(sc_u * U_rti), static_cast<vector<double>>(sc_u * U_nlp), 1e-5, "initialized real-time iteration equals the SQP solution");
+
+    for (const char *file : {"test_rti_riccati.yaml", "test_rti_qrqp.yaml", "test_rti_init.yaml", "test_rti_nlp.yaml"})
+    {
+        std::remove(file);
+    }
+    return Result();
+}
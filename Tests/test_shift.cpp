@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <casadi/casadi.hpp>
+#include "Check.h"
+#include "ShootingGrid.h"
+
+using casadi::DM;
+using casadi::Slice;
+using std::string;
+using std::vector;
+using namespace nmpc;
+using namespace nmpc::test;
+
+namespace
+{
+    // State trajectory, which is linear in time (so the linear interpolation of the shift is exact)
+    DM LinearState(double t)
+    {
+        return DM(vector<double>{t, 3 - 2 * t});
+    }
+
+    // Shift a linear state trajectory and piecewise constant controls on the grid h, and compare them with the trajectories
+    // evaluated at the shifted node times t_k + h_0 (the state x_next and the control u_N extend the grid by one interval of the last step size)
+    void CheckShift(const vector<double> &h, const string &what)
+    {
+        const int n_shoot{static_cast<int>(h.size())};
+        vector<double> t(n_shoot + 2, 0.0);
+        for (int i = 0; i <= n_shoot; i++)
+        {
+            t[i + 1] = t[i] + h[std::min(i, n_shoot - 1)];
+        }
+        vector<DM> X_nodes;
+        vector<DM> U_nodes;
+        for (int k = 0; k <= n_shoot; k++)
+        {
+            X_nodes.push_back(LinearState(t[k]));
+            if (k < n_shoot)
+            {
+                U_nodes.push_back(DM(10.0 * k + 1));
+            }
+        }
+        DM X{DM::horzcat(X_nodes)};
+        DM U{DM::horzcat(U_nodes)};
+        const DM u_N{10.0 * n_shoot + 1};
+        ShiftTrajectories(ShiftPositions(h), X, U, LinearState(t[n_shoot + 1]), u_N);
+
+        Check(X.size2() == n_shoot + 1 && U.size2() == n_shoot, what + ": dimensions of the shifted trajectories");
+        for (int k = 0; k <= n_shoot && X.size2() == n_shoot + 1; k++)
+        {
+            const double s{t[k] + h[0]};
+            CheckNear(static_cast<vector<double>>(X(Slice(), k)), static_cast<vector<double>>(LinearState(s)), 1e-9 * t[n_shoot + 1],
+                      what + ": state of the shifted node " + std::to_string(k));
+            // Control of the interval of the extended grid, which contains the shifted node time
+            int i{0};
+            while (i < n_shoot && t[i + 1] <= s + 1e-9 * h[0])
+            {
+                i++;
+            }
+            if (k < n_shoot && U.size2() == n_shoot)
+            {
+                CheckNear(static_cast<vector<double>>(U(Slice(), k)), {10.0 * i + 1}, 0, what + ": control of the shifted interval " + std::to_string(k));
+            }
+        }
+    }
+
+    // Shift the state trajectory of consecutive samples (the warm start of each sample starts from the shifted trajectory of the
+    // previous one), the interpolation errors must not accumulate for a linear state trajectory
+    void CheckRepeatedShift(const vector<double> &h, int n_samples, const string &what)
+    {
+        const int n_shoot{static_cast<int>(h.size())};
+        vector<double> t(n_shoot + 2, 0.0);
+        for (int i = 0; i <= n_shoot; i++)
+        {
+            t[i + 1] = t[i] + h[std::min(i, n_shoot - 1)];
+        }
+        vector<DM> X_nodes;
+        for (int k = 0; k <= n_shoot; k++)
+        {
+            X_nodes.push_back(LinearState(t[k]));
+        }
+        DM X{DM::horzcat(X_nodes)};
+        DM U{DM::zeros(1, n_shoot)};
+        const vector<double> shift_pos{ShiftPositions(h)};
+        for (int s = 0; s < n_samples; s++)
+        {
+            ShiftTrajectories(shift_pos, X, U, LinearState(t[n_shoot + 1] + s * h[0]), DM(0));
+        }
+        for (int k = 0; k <= n_shoot; k++)
+        {
+            CheckNear(static_cast<vector<double>>(X(Slice(), k)), static_cast<vector<double>>(LinearState(t[k] + n_samples * h[0])),
+                      1e-9 * (t[n_shoot + 1] + n_samples * h[0]), what + ": state of node " + std::to_string(k) + " after " + std::to_string(n_samples) + " samples");
+        }
+    }
+} // namespace
+
+int main()
+{
+    // Uniform grid: plain shift by one interval
+    Check(ShiftPositions({0.5, 0.5, 0.5, 0.5}).empty(), "uniform grid has no shift positions");
+    CheckShift({0.5, 0.5, 0.5, 0.5}, "uniform grid");
+    // Non-uniform grids: explicit step sizes and a geometrically growing step size (dt_growth), whose node times are not exact in floating point
+    CheckShift({1, 1, 2, 4}, "explicit step sizes");
+    const vector<double> h_growth{GrowingStepSizes(0.002, 1.1, 20)};
+    vector<double> h_growth_ref;
+    for (int i = 0; i < 20; i++)
+    {
+        h_growth_ref.push_back(0.002 * std::pow(1.1, i));
+    }
+    CheckNear(h_growth, h_growth_ref, 1e-15, "step sizes of the growing grid");
+    CheckNear(GrowingStepSizes(0.5, 1, 4), {0.5, 0.5, 0.5, 0.5}, 0, "step sizes without growth");
+    CheckShift(h_growth, "growing step size");
+    CheckRepeatedShift(h_growth, 25, "growing step size");
+    CheckRepeatedShift({1, 1, 2, 4}, 5, "explicit step sizes");
+    // The first shifted node is the second node of the grid
+    const vector<double> shift_pos{ShiftPositions(h_growth)};
+    Check(!shift_pos.empty() && std::fabs(shift_pos[0] - 1) < 1e-12, "first shifted node of the growing grid");
+    return Result();
+}
@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <casadi/casadi.hpp>
+#include "Check.h"
+#include "ShootingGrid.h"
+
+using casadi::DM;
+using std::string;
+using std::vector;
+using namespace nmpc;
+using namespace nmpc::test;
+
+namespace
+{
+    // Multiplier of the constraint row k of the block with the offset of interval i
+    double Multiplier(double block, int i, int k)
+    {
+        return block + 10.0 * i + k;
+    }
+
+    // Shift the multipliers of the constraint layout of the OCP and check that each stage-wise block moves one interval forward
+    // and repeats its last interval, while the multipliers of the initial condition are kept
+    void CheckShift(int nx, int n_shoot, int n_stage, int n_coll, const string &what)
+    {
+        const vector<int> n_rows{nx, n_stage, n_coll};
+        const vector<double> offset{1000, 2000, 3000};
+        vector<double> lam;
+        vector<double> lam_ref;
+        for (int block = 0; block < 3; block++)
+        {
+            for (int i = 0; i < n_shoot; i++)
+            {
+                for (int k = 0; k < n_rows[block]; k++)
+                {
+                    lam.push_back(Multiplier(offset[block], i, k));
+                    lam_ref.push_back(Multiplier(offset[block], std::min(i + 1, n_shoot - 1), k));
+                }
+            }
+            // Initial condition between the stage constraints and the collocation equations
+            for (int k = 0; k < nx && block == 1; k++)
+            {
+                lam.push_back(-1.0 - k);
+                lam_ref.push_back(-1.0 - k);
+            }
+        }
+        DM lam_g(lam);
+        Check(ShiftMultipliers(lam_g, nx, n_shoot, n_stage, n_coll), what + ": layout of the multipliers");
+        CheckNear(static_cast<vector<double>>(lam_g), lam_ref, 0, what + ": shifted multipliers");
+
+        // Multipliers of another layout (e.g. the block-wise input constraints of move blocking) are kept
+        DM lam_other(vector<double>(lam.begin(), lam.end() - 1));
+        Check(!ShiftMultipliers(lam_other, nx, n_shoot, n_stage, n_coll), what + ": other layout is rejected");
+        CheckNear(static_cast<vector<double>>(lam_other), vector<double>(lam.begin(), lam.end() - 1), 0, what + ": multipliers of another layout");
+    }
+} // namespace
+
+int main()
+{
+    // Multiple shooting (no collocation equations) with 4 states and 6 stage constraints per interval
+    CheckShift(4, 10, 6, 0, "multiple shooting");
+    // Collocation of degree 3
+    CheckShift(4, 10, 6, 12, "collocation");
+    // Without stage constraints and with a single interval, whose multipliers are kept
+    CheckShift(2, 5, 0, 0, "no stage constraints");
+    CheckShift(2, 1, 3, 6, "single interval");
+    return Result();
+}
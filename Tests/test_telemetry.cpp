@@ -0,0 +1,155 @@
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+#include "Check.h"
+#include "SolverTelemetry.h"
+
+using std::string;
+using std::vector;
+using namespace nmpc;
+using namespace nmpc::test;
+
+namespace
+{
+    const int capacity{8};
+    const int n_record{20};
+    const double deadline{1e-3};
+
+    // Solve time of sample i (away from the deadline and from the edges of the histogram bins)
+    double SolveTime(int i)
+    {
+        return (i + 1.5) * 1e-4;
+    }
+
+    // Solver error message with characters, which have to be quoted in CSV and escaped in JSON
+    const char *error_status{"Error \"x\",\nline\\2"};
+
+    // Number of samples recorded while another thread reads the telemetry
+    const int n_concurrent{200000};
+
+    // Sample, whose fields are all derived from its index
+    SampleTelemetry IndexedSample(int i)
+    {
+        SampleTelemetry sample{};
+        sample.t_init_wall = i;
+        sample.t_solve_wall = 1e-6 * i;
+        sample.t_extract_cpu = -i;
+        sample.iter_count = i;
+        sample.constr_viol = 2.0 * i;
+        std::snprintf(sample.return_status.data(), sample.return_status.size(), "sample %d", i);
+        return sample;
+    }
+
+    // The fields of the sample belong to the same recorded sample
+    bool Consistent(const SampleTelemetry &sample)
+    {
+        const int i{static_cast<int>(sample.sample)};
+        const SampleTelemetry expected{IndexedSample(i)};
+        return sample.t_init_wall == expected.t_init_wall && sample.t_solve_wall == expected.t_solve_wall && sample.t_extract_cpu == expected.t_extract_cpu &&
+               sample.iter_count == i && sample.constr_viol == expected.constr_viol && std::strcmp(sample.return_status.data(), expected.return_status.data()) == 0;
+    }
+} // namespace
+
+int main()
+{
+    SolverTelemetry telemetry(TelemetryParams{capacity, deadline});
+    for (int i = 0; i < n_record; i++)
+    {
+        SampleTelemetry sample{};
+        sample.t_solve_wall = SolveTime(i);
+        sample.iter_count = i;
+        sample.success = i < n_record - 2;
+        std::strncpy(sample.return_status.data(), i < n_record - 1 ? "Solve_Succeeded" : error_status, sample.return_status.size() - 1);
+        sample.constr_viol = i == n_record - 2 ? NAN : 1e-9;
+        telemetry.Record(sample);
+    }
+
+    // The ring buffer keeps the last samples in the order of recording
+    const int n_kept{capacity};
+    const int first{n_record - n_kept};
+    const vector<SampleTelemetry> samples{telemetry.Samples()};
+    Check(telemetry.n_samples() == n_record && samples.size() == n_kept, "number of recorded and kept samples");
+    for (std::size_t k = 0; k < samples.size(); k++)
+    {
+        const int i{first + static_cast<int>(k)};
+        Check(samples[k].sample == static_cast<std::uint64_t>(i) && samples[k].iter_count == i && samples[k].t_solve_wall == SolveTime(i),
+              "kept sample " + std::to_string(k) + " is sample " + std::to_string(i));
+    }
+    Check(telemetry.last().sample == n_record - 1, "last sample");
+
+    // Deadline misses and latency percentiles over all samples (upper edges of the histogram bins, 20 bins per decade)
+    int n_miss{0};
+    for (int i = 0; i < n_record; i++)
+    {
+        n_miss += SolveTime(i) > deadline;
+    }
+    Check(telemetry.deadline_misses() == static_cast<std::uint64_t>(n_miss) && samples.back().deadline_miss &&
+              samples.front().deadline_miss == (SolveTime(first) > deadline),
+          "deadline misses");
+    const double bin_width{std::pow(10, 1 / 20.0)};
+    const LatencyPercentiles latency{telemetry.Latency()};
+    Check(latency.max == SolveTime(n_record - 1), "maximum latency");
+    Check(latency.p50 >= SolveTime(n_record / 2 - 1) && latency.p50 <= SolveTime(n_record / 2 - 1) * bin_width, "median latency");
+    Check(latency.p95 >= SolveTime(n_record - 2) && latency.p99 <= latency.max, "95% and 99% latency percentiles");
+    Check(telemetry.SolveLatency().max == latency.max, "solve latency");
+
+    // The JSON file is valid (parsed as YAML) with the escaped error message and null for the non-finite constraint violation
+    telemetry.WriteJSON("test_telemetry.json");
+    const YAML::Node json = YAML::LoadFile("test_telemetry.json");
+    const YAML::Node json_samples = json["samples"];
+    Check(json["n_samples"].as<int>() == n_record && json["deadline_misses"].as<int>() == n_miss && json_samples.size() == n_kept, "JSON summary");
+    Check(json_samples.size() == n_kept && json_samples[n_kept - 2]["constr_viol"].IsNull(), "JSON null for a non-finite constraint violation");
+    Check(json_samples.size() == n_kept && json_samples[n_kept - 1]["return_status"].as<string>() == error_status, "JSON escaping of the return status");
+    std::remove("test_telemetry.json");
+
+    // The CSV field of the error message is quoted and the non-finite constraint violation is empty
+    telemetry.WriteCSV("test_telemetry.csv");
+    std::ifstream csv_file("test_telemetry.csv");
+    std::stringstream csv;
+    csv << csv_file.rdbuf();
+    csv_file.close();
+    const string error_field{"\"Error \"\"x\"\",\nline\\2\""};
+    Check(csv.str().find("," + error_field + ",1e-09,1\n") != string::npos, "CSV quoting of the return status");
+    Check(csv.str().find("," + std::to_string(n_record - 2) + ",0,Solve_Succeeded,,1\n") != string::npos, "empty CSV field for a non-finite constraint violation");
+    std::remove("test_telemetry.csv");
+
+    // A reader thread only gets complete samples while the controller thread records (each field is derived from the sample index),
+    // in the order of recording
+    SolverTelemetry concurrent(TelemetryParams{capacity, 0});
+    std::atomic<bool> recording{true};
+    std::atomic<int> n_torn{0};
+    std::atomic<int> n_unordered{0};
+    std::thread reader([&] {
+        while (recording.load())
+        {
+            const vector<SampleTelemetry> read{concurrent.Samples()};
+            for (std::size_t k = 0; k < read.size(); k++)
+            {
+                n_torn += !Consistent(read[k]);
+                n_unordered += k > 0 && read[k].sample <= read[k - 1].sample;
+            }
+            if (concurrent.n_samples() > 0)
+            {
+                n_torn += !Consistent(concurrent.last());
+            }
+        }
+    });
+    for (int i = 0; i < n_concurrent; i++)
+    {
+        concurrent.Record(IndexedSample(i));
+    }
+    recording.store(false);
+    reader.join();
+    Check(n_torn.load() == 0, "no torn samples for a concurrent reader");
+    Check(n_unordered.load() == 0, "samples of a concurrent reader in the order of recording");
+    Check(concurrent.Samples().size() == static_cast<std::size_t>(capacity) && concurrent.last().sample == n_concurrent - 1, "samples after the concurrent recording");
+
+    return Result();
+}
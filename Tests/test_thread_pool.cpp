@@ -0,0 +1,79 @@
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Check.h"
+#include "ThreadPool.h"
+
+using std::vector;
+using namespace nmpc;
+using namespace nmpc::test;
+
+namespace
+{
+    // Run a parallel loop and check that every loop index is visited exactly once
+    void CheckCoverage(ThreadPool &pool, int n, const std::string &what)
+    {
+        vector<std::atomic<int>> visits(n);
+        for (std::atomic<int> &v : visits)
+        {
+            v.store(0);
+        }
+        pool.ParallelFor(n, [&](int i) { visits[i].fetch_add(1); });
+        bool once{true};
+        for (const std::atomic<int> &v : visits)
+        {
+            once = once && v.load() == 1;
+        }
+        Check(once, what + ": every loop index is visited exactly once");
+    }
+} // namespace
+
+int main()
+{
+    ThreadPool pool(4);
+    Check(pool.n_threads() == 4, "number of worker threads");
+    Check(ThreadPool(0).n_threads() == 1, "at least one worker thread");
+
+    // Fewer, as many and more loop indices than workers, repeated on the same pool
+    for (int n : {0, 1, 3, 4, 1000})
+    {
+        CheckCoverage(pool, n, "loop over " + std::to_string(n) + " indices");
+    }
+
+    // Uneven loop bodies: the slow indices are all in the queue of the first worker, the other workers steal the rest of it
+    const int n_uneven{16};
+    vector<std::thread::id> thread_ids(n_uneven);
+    pool.ParallelFor(n_uneven, [&](int i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(i < 4 ? 50 : 1));
+        thread_ids[i] = std::this_thread::get_id();
+    });
+    int n_first{0};
+    for (int i = 1; i < 4; i++)
+    {
+        n_first += thread_ids[i] == thread_ids[0];
+    }
+    Check(n_first < 3, "slow loop bodies of one queue are stolen by other workers");
+
+    // The first exception of a loop body is rethrown, the pool remains usable
+    bool thrown{false};
+    try
+    {
+        pool.ParallelFor(100, [](int i) {
+            if (i == 42)
+            {
+                throw std::runtime_error("loop body 42");
+            }
+        });
+    }
+    catch (const std::runtime_error &e)
+    {
+        thrown = std::string(e.what()) == "loop body 42";
+    }
+    Check(thrown, "exception of a loop body is rethrown in the calling thread");
+    CheckCoverage(pool, 100, "loop after an exception");
+
+    return Result();
+}
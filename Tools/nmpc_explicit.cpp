@@ -0,0 +1,57 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include "Config.h"
+#include "ExplicitPolicy.h"
+#include "IntegratorRK4.h"
+#include "ModelCSTR.h"
+#include "ModelDIPC.h"
+#include "OptimalControlProblem.h"
+
+using namespace std;
+using namespace casadi;
+using namespace nmpc;
+
+// Samples the explicit policy of an example offline and serializes it to nmpc.explicit.file
+int main(int argc, char **argv)
+{
+    if (argc != 4 || (string(argv[1]) != "cstr" && string(argv[1]) != "dipc"))
+    {
+        cerr << "Usage: ./nmpc_explicit cstr|dipc path_to_config path_to_nmpc_model" << endl;
+        return EXIT_FAILURE;
+    }
+
+    const string example{argv[1]};
+    const string config_file{argv[2]};
+    const string nmpc_model_file{argv[3]};
+
+    // The grid points are solved with fully converged NLPs
+    if (LoadConfig(config_file)["nmpc.mode"].as<string>("nlp") == "rti")
+    {
+        cerr << "The explicit policy is sampled with the NLP solver, nmpc.mode must be \"nlp\" or \"explicit\"" << endl;
+        return EXIT_FAILURE;
+    }
+
+    unique_ptr<ModelBase<MX>> model;
+    if (example == "cstr")
+    {
+        model.reset(new ModelCSTR<MX>(nmpc_model_file));
+    }
+    else
+    {
+        model.reset(new ModelDIPC<MX>(nmpc_model_file));
+    }
+    const IntegratorRK4<MX> integrator;
+    const OptimalControlProblem ocp{config_file, *model, integrator};
+    const ExplicitPolicyParams params{ReadExplicitPolicyParams(config_file)};
+
+    const auto t_start = chrono::steady_clock::now();
+    const ExplicitPolicy policy{ExplicitPolicy::Sample(ocp, params)};
+    const double t_sample{chrono::duration<double>(chrono::steady_clock::now() - t_start).count()};
+    policy.Save(params.file);
+
+    cout << "Explicit policy: " << policy.n_valid() << " of " << policy.n_points() << " grid points solved in " << t_sample << " s, written to " << params.file
+         << endl;
+
+    return EXIT_SUCCESS;
+}
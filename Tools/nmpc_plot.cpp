@@ -0,0 +1,66 @@
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include "Plot.h"
+#include "TrajectoryRecorder.h"
+
+using namespace std;
+using namespace nmpc;
+
+// Converts a recorded trajectory file to CSV and plots its columns over time (offline, so the controller process does not need Python)
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        cerr << "Usage: ./nmpc_plot path_to_trajectory output_prefix" << endl;
+        return EXIT_FAILURE;
+    }
+
+    const string trajectory_file{argv[1]};
+    const string prefix{argv[2]};
+    const Trajectory trajectory{ReadTrajectory(trajectory_file)};
+    const size_t n_columns{trajectory.columns.size()};
+    const size_t n_records{n_columns > 0 ? trajectory.data[0].size() : 0};
+
+    // CSV file with all records
+    ofstream csv(prefix + ".csv");
+    csv << setprecision(numeric_limits<double>::max_digits10);
+    for (size_t c = 0; c < n_columns; c++)
+    {
+        csv << (c > 0 ? "," : "") << trajectory.columns[c];
+    }
+    csv << "\n";
+    for (size_t r = 0; r < n_records; r++)
+    {
+        for (size_t c = 0; c < n_columns; c++)
+        {
+            csv << (c > 0 ? "," : "") << trajectory.data[c][r];
+        }
+        csv << "\n";
+    }
+
+    // Plot the states and controls over the time (first column)
+    for (size_t c = 1; c < n_columns; c++)
+    {
+        const string &name{trajectory.columns[c]};
+        if (name.compare(0, 2, "x_") != 0 && name.compare(0, 2, "u_") != 0)
+        {
+            continue;
+        }
+        // The controls are not defined for the final state
+        vector<double> t{trajectory.data[0]};
+        vector<double> y{trajectory.data[c]};
+        if (name[0] == 'u' && !y.empty() && y.back() != y.back())
+        {
+            t.pop_back();
+            y.pop_back();
+        }
+        const string title{string(name[0] == 'x' ? "Simulated state " : "Simulated control ") + name + " over time"};
+        Plot(prefix + "_" + name + ".png", title, "t", t, name, y);
+    }
+
+    cout << n_records << " records written to " << prefix << ".csv" << endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <casadi/casadi.hpp>
+#include "Integrator.h"
+#include "ModelBase.h"
+#include "NonlinearModelPredictiveControl.h"
+
+namespace nmpc
+{
+    // Asynchronous controller parameters from the config file
+    struct AsyncParams
+    {
+        // Predict the measured state forward by the expected computation delay before solving
+        bool compensate;
+        // Initial estimate of the computation delay (wall-clock seconds)
+        double delay;
+        // Filter constant of the exponential moving average of the measured computation delays (0: keep the initial estimate)
+        double delay_filter;
+        // Maximum step size of the delay prediction (model time)
+        double dt;
+        // Model time units per second of wall-clock time (e.g. 1/3600 for a model in hours), converts the delay to model time
+        double time_scale;
+    };
+
+    // Control published by the asynchronous controller
+    struct AsyncControl
+    {
+        // Control input
+        std::vector<double> u;
+        // Time of the measurement and time from which the control is meant to be applied (measurement time + predicted delay), in model time
+        double t_meas;
+        double t_valid;
+        // Number of the solved sample
+        std::uint64_t sample;
+    };
+
+    // Asynchronous NMPC: the OCP is solved on a dedicated worker thread, so a fixed-rate plant loop never blocks on the solver
+    // The plant loop hands over its measurements without waiting (only the latest unsolved measurement is kept) and reads the latest control.
+    // Before each solve, the measured state is predicted forward by the expected computation delay with the model and the integrator
+    // of the controller, applying the control which the plant uses in the meantime
+    class AsyncController
+    {
+    public:
+        // Custom constructor: read the parameters from the config file, build the OCP and start the worker thread
+        AsyncController(const std::string &config_file, const ModelBase<casadi::MX> &model, const Integrator<casadi::MX> &integrator);
+
+        // Stop and join the worker thread
+        ~AsyncController();
+
+        AsyncController(const AsyncController &) = delete;
+        AsyncController &operator=(const AsyncController &) = delete;
+
+        // Hand over the measured state at the model time t_meas to the worker (non-blocking, replaces a measurement which is not yet solved)
+        void SetMeasurement(const casadi::DM &x_meas, double t_meas);
+
+        // Get the latest published control, returns false if no sample is solved yet
+        // An exception of the worker thread is rethrown here
+        bool GetControl(AsyncControl &control) const;
+
+        // Get the current estimate of the computation delay (wall-clock seconds)
+        inline double delay() const
+        {
+            return delay_.load(std::memory_order_relaxed);
+        }
+
+        // Get the per-sample solver telemetry of the controller
+        inline const SolverTelemetry &telemetry() const
+        {
+            return nmpc_.telemetry();
+        }
+
+    private:
+        // Read parameters from yaml file
+        void ReadParams(const std::string &config_file);
+
+        // Solve the latest measurement until the controller is stopped
+        void WorkerLoop();
+
+        // Predict the state x forward by the model time t with the constant control u
+        casadi::DM Predict(const casadi::DM &x, const std::vector<double> &u, double t) const;
+
+        // Publish the control of a solved sample (swap of the double buffer)
+        void Publish(const casadi::DM &u, double t_meas, double t_valid);
+
+        // Asynchronous controller config parameters
+        AsyncParams async_params_;
+        // Controller, which is only used by the worker thread
+        NonlinearModelPredictiveControl nmpc_;
+        // Integration step of the time-scaled model with the runtime parameters of the model: F(x, u, h, theta) -> x(h)
+        casadi::Function predict_;
+        // Estimate of the computation delay (wall-clock seconds)
+        std::atomic<double> delay_;
+
+        // Latest measurement, which is not yet solved
+        std::mutex measurement_mutex_;
+        std::condition_variable measurement_cv_;
+        casadi::DM x_meas_;
+        double t_meas_;
+        bool has_measurement_;
+        bool stop_;
+
+        // Double-buffered control output: the worker writes the back buffer, and swaps it with the front buffer under the lock
+        mutable std::mutex control_mutex_;
+        std::array<AsyncControl, 2> control_;
+        int front_;
+        bool has_control_;
+        std::exception_ptr exception_;
+
+        // Worker thread of the OCP solves
+        std::thread worker_;
+    };
+
+} // namespace nmpc
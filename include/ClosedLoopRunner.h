@@ -0,0 +1,207 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <casadi/casadi.hpp>
+#include "Integrator.h"
+#include "ModelBase.h"
+#include "NativeSimulator.h"
+#include "NativeVector.h"
+#include "NonlinearModelPredictiveControl.h"
+#include "Simulator.h"
+#include "ThreadPool.h"
+
+namespace nmpc
+{
+    // Closed-loop runner parameters from the config file
+    struct ClosedLoopParams
+    {
+        // Number of worker threads for the closed-loop scenarios
+        int n_threads;
+    };
+
+    // Read the closed-loop runner parameters from the config file
+    ClosedLoopParams ReadClosedLoopParams(const std::string &config_file);
+
+    // One closed-loop scenario
+    struct ClosedLoopScenario
+    {
+        // Initial state of the plant and the controller
+        casadi::DM x_0;
+        // Scaling of the plant model parameters (model mismatch), no scaling uses the simulator model
+        ModelScaling scaling;
+        // Reference of the states x_e_index: a setpoint or a preview (see NonlinearModelPredictiveControl::SetReference),
+        // empty for the reference of the config file
+        casadi::DM x_ref;
+        // Diagonals of the weighting matrices Q, R and P, empty for the weights of the config file
+        casadi::DM q;
+        casadi::DM r;
+        casadi::DM p;
+    };
+
+    // Closed-loop response of one scenario
+    struct ClosedLoopResult
+    {
+        // Simulated time, state and control trajectories
+        casadi::DM t;
+        casadi::DM x;
+        casadi::DM u;
+        // NMPC computation time of each sample
+        std::vector<double> t_nmpc;
+        // Root mean square deviation of the required terminal states from their setpoints
+        double tracking_rms;
+    };
+
+    // Aggregate metrics of all scenarios of a run
+    struct ClosedLoopMetrics
+    {
+        // Number of scenarios and of NMPC samples over all scenarios
+        int n_scenarios;
+        int n_samples;
+        // Wall time of the run
+        double t_wall;
+        // NMPC computation time per sample over all scenarios
+        double t_nmpc_mean;
+        double t_nmpc_p95;
+        double t_nmpc_max;
+        // Tracking error over the scenarios
+        double tracking_rms_mean;
+        double tracking_rms_max;
+    };
+
+    // Compute the aggregate metrics of the closed-loop results
+    ClosedLoopMetrics SummarizeClosedLoop(const std::vector<ClosedLoopResult> &results, double t_wall);
+
+    // Print the aggregate metrics
+    std::ostream &operator<<(std::ostream &os, const ClosedLoopMetrics &metrics);
+
+    // Runs many closed-loop scenarios (NMPC + simulated plant) in parallel on a work-stealing thread pool
+    // The NMPC instances are copies of one built controller, so the OCP is built (and its code generated) only once
+    // The plant is simulated with native vectors of capacity N
+    template <int N>
+    class ClosedLoopRunner
+    {
+    public:
+        using Vector = NativeVector<N>;
+        using ModelFactory = typename NativeSimulator<N>::ModelFactory;
+
+        // Custom constructor: read the simulation and runner parameters from the config file
+        // Scenarios with a model scaling need the model_factory to create their plant model
+        ClosedLoopRunner(const std::string &config_file, const NonlinearModelPredictiveControl &nmpc, const ModelBase<Vector> &sim_model,
+                         const Integrator<Vector> &sim_integrator, const ModelFactory &model_factory = nullptr)
+            : sim_params_(ReadSimParams(config_file)), nmpc_(nmpc), sim_model_(sim_model), sim_integrator_(sim_integrator), model_factory_(model_factory),
+              pool_(ReadClosedLoopParams(config_file).n_threads)
+        {
+        }
+
+        // Simulate the closed loop of all scenarios from t0 to tf and update the aggregate metrics
+        // Throws std::invalid_argument if a scenario has a model scaling, but the runner has no model factory
+        std::vector<ClosedLoopResult> Run(const std::vector<ClosedLoopScenario> &scenarios)
+        {
+            // The controllers are copied on the calling thread (each copy gets its own solver instances), the workers evaluate the shared functions
+            // The reference and weights of a scenario are set on its copy before the loop, so invalid values throw before any scenario runs
+            std::vector<std::unique_ptr<Instance>> instances;
+            for (const ClosedLoopScenario &scenario : scenarios)
+            {
+                if (!scenario.scaling.empty() && !model_factory_)
+                {
+                    throw std::invalid_argument("The model scaling of a closed-loop scenario needs a model factory");
+                }
+                instances.emplace_back(new Instance(nmpc_, scenario.scaling.empty() ? nullptr : model_factory_(scenario.scaling),
+                                                    sim_params_, sim_model_, sim_integrator_));
+                if (!scenario.x_ref.is_empty())
+                {
+                    instances.back()->nmpc.SetReference(scenario.x_ref);
+                }
+                if (!scenario.q.is_empty() || !scenario.r.is_empty() || !scenario.p.is_empty())
+                {
+                    instances.back()->nmpc.SetWeights(scenario.q, scenario.r, scenario.p);
+                }
+            }
+            std::vector<ClosedLoopResult> results(scenarios.size());
+            const auto t_start = std::chrono::steady_clock::now();
+            pool_.ParallelFor(static_cast<int>(scenarios.size()), [&](int s) { results[s] = RunScenario(*instances[s], scenarios[s].x_0); });
+            metrics_ = SummarizeClosedLoop(results, std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count());
+            return results;
+        }
+
+        // Get the aggregate metrics of the last run
+        inline const ClosedLoopMetrics &metrics() const
+        {
+            return metrics_;
+        }
+
+    private:
+        // NMPC and plant of one scenario
+        struct Instance
+        {
+            Instance(const NonlinearModelPredictiveControl &nmpc, std::unique_ptr<ModelBase<Vector>> model, const SimParams &sim_params,
+                     const ModelBase<Vector> &sim_model, const Integrator<Vector> &sim_integrator)
+                : nmpc(nmpc), model(std::move(model)), sim(sim_params, this->model ? *this->model : sim_model, sim_integrator)
+            {
+            }
+
+            NonlinearModelPredictiveControl nmpc;
+            std::unique_ptr<ModelBase<Vector>> model;
+            NativeSimulator<N> sim;
+        };
+
+        // Simulate the closed loop of one scenario
+        ClosedLoopResult RunScenario(Instance &instance, const casadi::DM &x_0) const
+        {
+            NonlinearModelPredictiveControl &nmpc{instance.nmpc};
+            const NativeSimulator<N> &sim{instance.sim};
+            const int n_samples{static_cast<int>((sim.tf() - sim.t0()) / sim.dt())};
+            ClosedLoopResult result;
+            result.t = casadi::DM::zeros(1, n_samples + 1);
+            result.x = casadi::DM::zeros(nmpc.nx(), n_samples + 1);
+            result.u = casadi::DM::zeros(nmpc.nu(), n_samples);
+            result.t_nmpc.reserve(n_samples);
+            casadi::Slice all;
+            result.t(0) = sim.t0();
+            result.x(all, 0) = x_0;
+            nmpc.Reset(x_0);
+            const std::vector<double> x_e(nmpc.x_e());
+            double tracking_sq{0};
+            for (int k = 0; k < n_samples; k++)
+            {
+                result.t(k + 1) = sim.t0() + (k + 1) * sim.dt();
+                const auto t_start = std::chrono::steady_clock::now();
+                result.u(all, k) = nmpc.ComputeControlInput();
+                result.t_nmpc.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count());
+                const Vector x_k{std::vector<double>(result.x(all, k))};
+                const Vector u_k{std::vector<double>(result.u(all, k))};
+                const Vector x_next{sim.ApplyControlForTimeStep(x_k, u_k)};
+                result.x(all, k + 1) = std::vector<double>(x_next);
+                nmpc.SetInitialCondition(result.x(all, k + 1));
+                for (int c = 0; c < static_cast<int>(x_e.size()); c++)
+                {
+                    const double e{x_next(nmpc.x_e_index()[c]) - x_e[c]};
+                    tracking_sq += e * e;
+                }
+            }
+            result.tracking_rms = n_samples > 0 && !x_e.empty() ? std::sqrt(tracking_sq / (n_samples * x_e.size())) : 0;
+            return result;
+        }
+
+        // Simulation parameters
+        const SimParams sim_params_;
+        // Built controller, which is copied for every scenario
+        const NonlinearModelPredictiveControl &nmpc_;
+        // Plant model and integrator
+        const ModelBase<Vector> &sim_model_;
+        const Integrator<Vector> &sim_integrator_;
+        // Creates the plant model of scenarios with a model scaling
+        const ModelFactory model_factory_;
+        // Worker threads for the scenarios
+        ThreadPool pool_;
+        // Aggregate metrics of the last run
+        ClosedLoopMetrics metrics_{};
+    };
+
+} // namespace nmpc
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+
+namespace nmpc
+{
+    // Coefficients of the collocation polynomial through the points tau_0, ..., tau_d (tau_0 = 0 for the state at the beginning
+    // of the interval) from the Lagrange polynomials l_j of the points: C(j, r) = dl_j/dtau(tau_r) (column-major, (d+1) x (d+1))
+    // for the derivatives at the points and D(j) = l_j(1) for the state at the end of the interval
+    inline void CollocationCoefficients(const std::vector<double> &tau, std::vector<double> &C, std::vector<double> &D)
+    {
+        const int d{static_cast<int>(tau.size()) - 1};
+        C.assign((d + 1) * (d + 1), 0.0);
+        D.assign(d + 1, 1.0);
+        for (int j = 0; j <= d; j++)
+        {
+            for (int m = 0; m <= d; m++)
+            {
+                if (m == j)
+                {
+                    continue;
+                }
+                D[j] *= (1 - tau[m]) / (tau[j] - tau[m]);
+                for (int r = 0; r <= d; r++)
+                {
+                    double dl{1 / (tau[j] - tau[m])};
+                    for (int n = 0; n <= d; n++)
+                    {
+                        if (n != j && n != m)
+                        {
+                            dl *= (tau[r] - tau[n]) / (tau[j] - tau[n]);
+                        }
+                    }
+                    C[j + r * (d + 1)] += dl;
+                }
+            }
+        }
+    }
+
+} // namespace nmpc
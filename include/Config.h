@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+#include <yaml-cpp/yaml.h>
+
+namespace nmpc
+{
+    // Parsed config file, which is shared by all classes reading their parameters from the same file
+    // The file is parsed once per process and again only if its contents change. The returned node must not be modified
+    // (use YAML::Clone for a modifiable copy)
+    const YAML::Node LoadConfig(const std::string &config_file);
+
+    // Hash of the contents of the config file
+    std::size_t ConfigHash(const std::string &config_file);
+
+} // namespace nmpc
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "OptimalControlProblem.h"
+
+namespace nmpc
+{
+    // Explicit policy parameters from the config file
+    struct ExplicitPolicyParams
+    {
+        // File of the serialized table
+        std::string file;
+        // Box of the sampled states (default: state constraints of the OCP)
+        std::vector<double> x_min;
+        std::vector<double> x_max;
+        // Number of grid points per state
+        std::vector<int> n_grid;
+        // Quality check: maximum spread of the controls at the corners of a grid cell, relative to the range of the controls in the table
+        double tol;
+        // Number of worker threads for sampling the table
+        int n_threads;
+        // Hash of the config entries, which define the sampled OCP (checked when the table is loaded)
+        std::size_t config_hash;
+    };
+
+    // Read the explicit policy parameters from the config file
+    ExplicitPolicyParams ReadExplicitPolicyParams(const std::string &config_file);
+
+    // Explicit NMPC policy: the first control of the OCP solution, sampled offline on a regular state grid and interpolated multilinearly
+    class ExplicitPolicy
+    {
+    public:
+        // Default constructor: empty table (no coverage)
+        ExplicitPolicy() : config_hash_{0}, model_hash_{0}, nx_{0}, nu_{0}, tol_{0}
+        {
+        }
+
+        // Solve the OCP for all grid points in parallel (copies of the built OCP, cold started from the grid point)
+        static ExplicitPolicy Sample(const OptimalControlProblem &ocp, const ExplicitPolicyParams &params);
+
+        // Load a serialized table, the quality check uses the tolerance of the params
+        // Throws if the table was sampled with a different config (params.config_hash) or model (OptimalControlProblem::ModelHash)
+        static ExplicitPolicy Load(const ExplicitPolicyParams &params, std::size_t model_hash);
+
+        // Serialize the table to the file
+        void Save(const std::string &file) const;
+
+        // Interpolate the control for the state x
+        // Returns false if x is outside of the table, a corner of its grid cell was not solved successfully or the quality check fails
+        bool Evaluate(const std::vector<double> &x, std::vector<double> &u) const;
+
+        // Get the number of grid points
+        inline int n_points() const
+        {
+            return static_cast<int>(valid_.size());
+        }
+
+        // Get the number of successfully solved grid points
+        int n_valid() const;
+
+    private:
+        // Strides of the grid point indices (first state fastest) and the range of the controls in the table
+        void Index();
+
+        // Hashes of the config and the model, which the table was sampled with
+        std::size_t config_hash_;
+        std::size_t model_hash_;
+        // Dimensions
+        int nx_;
+        int nu_;
+        // Grid: box and number of points per state
+        std::vector<double> x_min_;
+        std::vector<double> x_max_;
+        std::vector<int> n_grid_;
+        std::vector<int> stride_;
+        // Controls (nu per grid point) and success flags of the grid points
+        std::vector<double> u_;
+        std::vector<char> valid_;
+        // Quality check tolerance and range of each control in the table
+        double tol_;
+        std::vector<double> u_range_;
+    };
+
+} // namespace nmpc
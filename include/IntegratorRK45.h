@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include <casadi/casadi.hpp>
+#include "Integrator.h"
+
+namespace nmpc
+{
+    // Symbolic state types are integrated with a fixed step schedule, numeric types with step size control
+    template <typename T>
+    struct IsSymbolic : std::false_type
+    {
+    };
+
+    template <>
+    struct IsSymbolic<casadi::MX> : std::true_type
+    {
+    };
+
+    // Embedded runge kutta 4(5) integrator class (Dormand-Prince)
+    // Numeric types (e.g. casadi::DM, NativeVector) adapt the step size over dt to the error tolerances,
+    // symbolic types (casadi::MX) use a fixed schedule of steps, e.g. recorded from a numeric simulation with Schedule()
+    template <typename T>
+    class IntegratorRK45 : public Integrator<T>
+    {
+    public:
+        // Custom constructor: error tolerances of the step size control and the step schedule (fractions of dt, default one step)
+        explicit IntegratorRK45(double abs_tol = 1e-6, double rel_tol = 1e-3, const std::vector<double> &schedule = {1.0})
+            : abs_tol_{abs_tol}, rel_tol_{rel_tol}, schedule_(schedule)
+        {
+        }
+
+        T operator()(const ModelBase<T> &model, double dt, const T &x, const T &u) const override
+        {
+            return Integrate(model, dt, x, u, nullptr, IsSymbolic<T>());
+        }
+
+        // Accepted step sizes of the adaptive integration over dt as fractions of dt (numeric types only)
+        std::vector<double> Schedule(const ModelBase<T> &model, double dt, const T &x, const T &u) const
+        {
+            static_assert(!IsSymbolic<T>::value, "The step schedule is recorded from a numeric simulation");
+            std::vector<double> schedule;
+            Integrate(model, dt, x, u, &schedule, std::false_type());
+            return schedule;
+        }
+
+    private:
+        // Fixed step schedule
+        T Integrate(const ModelBase<T> &model, double dt, const T &x, const T &u, std::vector<double> *, std::true_type) const
+        {
+            T x_next = x;
+            T err;
+            for (const double h : schedule_)
+            {
+                T k1 = model(x_next, u);
+                x_next = DormandPrinceStep(model, h * dt, x_next, u, k1, err);
+            }
+            return x_next;
+        }
+
+        // Adaptive step size, which starts with one step over dt
+        T Integrate(const ModelBase<T> &model, double dt, const T &x, const T &u, std::vector<double> *schedule, std::false_type) const
+        {
+            T x_k = x;
+            T k1 = model(x_k, u);
+            T err;
+            double t{0};
+            double h{dt};
+            while (dt - t > 1e-12 * dt)
+            {
+                h = std::min(h, dt - t);
+                T k7 = k1;
+                T x_next = DormandPrinceStep(model, h, x_k, u, k7, err);
+                const double e{ErrorNorm(err, x_k, x_next)};
+                if (!std::isfinite(e))
+                {
+                    // Reject the step of a non-finite model evaluation (e.g. overflow in a stiff region) and retry with a smaller step size
+                    if (h <= 1e-8 * dt)
+                    {
+                        throw std::runtime_error("RK45 integration failed: non-finite model evaluation at the minimum step size");
+                    }
+                    h *= 0.2;
+                    continue;
+                }
+                if (e <= 1 || h <= 1e-8 * dt)
+                {
+                    // Accept the step, the last stage is the first stage of the next step (first same as last)
+                    t += h;
+                    x_k = x_next;
+                    k1 = k7;
+                    if (schedule)
+                    {
+                        schedule->push_back(h / dt);
+                    }
+                }
+                h *= e > 0 ? std::min(5.0, std::max(0.2, 0.9 * std::pow(e, -0.2))) : 5.0;
+            }
+            return x_k;
+        }
+
+        // One step of the Dormand-Prince scheme
+        // Input: k (stage 1 at x), Output: 5th order solution, k (stage 7 at the solution), err (difference to the 4th order solution)
+        T DormandPrinceStep(const ModelBase<T> &model, double h, const T &x, const T &u, T &k, T &err) const
+        {
+            const T k1 = k;
+            const T k2 = model(x + h * (1.0 / 5 * k1), u);
+            const T k3 = model(x + h * (3.0 / 40 * k1 + 9.0 / 40 * k2), u);
+            const T k4 = model(x + h * (44.0 / 45 * k1 - 56.0 / 15 * k2 + 32.0 / 9 * k3), u);
+            const T k5 = model(x + h * (19372.0 / 6561 * k1 - 25360.0 / 2187 * k2 + 64448.0 / 6561 * k3 - 212.0 / 729 * k4), u);
+            const T k6 = model(x + h * (9017.0 / 3168 * k1 - 355.0 / 33 * k2 + 46732.0 / 5247 * k3 + 49.0 / 176 * k4 - 5103.0 / 18656 * k5), u);
+            const T x_next = x + h * (35.0 / 384 * k1 + 500.0 / 1113 * k3 + 125.0 / 192 * k4 - 2187.0 / 6784 * k5 + 11.0 / 84 * k6);
+            k = model(x_next, u);
+            err = h * (71.0 / 57600 * k1 - 71.0 / 16695 * k3 + 71.0 / 1920 * k4 - 17253.0 / 339200 * k5 + 22.0 / 525 * k6 - 1.0 / 40 * k);
+            return x_next;
+        }
+
+        // Root mean square of the error scaled with the tolerances
+        double ErrorNorm(const T &err, const T &x, const T &x_next) const
+        {
+            const int n{static_cast<int>(x.numel())};
+            double sum{0};
+            for (int i = 0; i < n; i++)
+            {
+                const double scale{abs_tol_ + rel_tol_ * std::max(std::fabs(static_cast<double>(x(i))), std::fabs(static_cast<double>(x_next(i))))};
+                const double e{static_cast<double>(err(i)) / scale};
+                sum += e * e;
+            }
+            return std::sqrt(sum / n);
+        }
+
+        // Absolute and relative error tolerance
+        double abs_tol_;
+        double rel_tol_;
+        // Fixed step schedule for symbolic types (fractions of dt)
+        std::vector<double> schedule_;
+    };
+
+} // namespace nmpc
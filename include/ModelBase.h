@@ -1,7 +1,34 @@
 #pragma once
 
+#include <map>
+#include <string>
+#include <vector>
+
 namespace nmpc
 {
+    // Scaling factors for model parameters from the model file, e.g. {"model.k_10", 1.05} (parameters without entry keep their value)
+    using ModelScaling = std::map<std::string, double>;
+
+    // Scalar type of the model parameters for the state type T (casadi matrices are their own scalar type)
+    template <typename T>
+    struct ScalarType
+    {
+        using type = T;
+    };
+
+    // Runtime parameter of a symbolic model: a model parameter, which is a symbol in the model equations and a parameter of the OCP,
+    // so it can be updated online (e.g. to track a drift of the plant)
+    template <typename T>
+    struct RuntimeParameter
+    {
+        // Name in the model file, e.g. "model.k_10"
+        std::string name;
+        // Symbol in the model equations
+        T symbol;
+        // Nominal value from the model file
+        double value;
+    };
+
     // Abstract model base class (interface for the first order nonlinear system equations)
     template <typename T>
     class ModelBase
@@ -12,6 +39,36 @@ namespace nmpc
         // Input: x_k (state at time k), u_k (control input at time k)
         // Output: x_dot_k (differential state at time k)
         virtual T operator()(const T &x_k, const T &u_k) const = 0;
+
+        // Descriptor form M(x_k)*x_dot_k = f(x_k, u_k) of the system equations, e.g. for mechanical models with a state dependent mass matrix
+        // Models in descriptor form evaluate operator() with a linear solve instead of a symbolic inverse, implicit schemes (collocation)
+        // use the mass matrix and the right-hand side directly
+        virtual bool descriptor_form() const
+        {
+            return false;
+        }
+
+        // Mass matrix M(x_k) of the descriptor form (only for models in descriptor form)
+        virtual T MassMatrix(const T &) const
+        {
+            return T();
+        }
+
+        // Right-hand side f(x_k, u_k) of the descriptor form (the system equations for models in explicit form)
+        virtual T RightHandSide(const T &x_k, const T &u_k) const
+        {
+            return (*this)(x_k, u_k);
+        }
+
+        // Get the runtime parameters, which are declared with model.runtime_parameters in the model file
+        // Only symbolic models (casadi::MX) have runtime parameters, numeric models use the values of the model file
+        inline const std::vector<RuntimeParameter<T>> &runtime_parameters() const
+        {
+            return runtime_parameters_;
+        }
+
+    protected:
+        std::vector<RuntimeParameter<T>> runtime_parameters_;
     };
 
 } // namespace nmpc
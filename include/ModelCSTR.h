@@ -35,8 +35,8 @@ namespace nmpc
     class ModelCSTR : public ModelBase<T>
     {
     public:
-        // Custom constructor: read CSTR parameters from the model file
-        ModelCSTR(const std::string &model_file);
+        // Custom constructor: read CSTR parameters from the model file, optionally scaled (e.g. for model-plant mismatch studies)
+        ModelCSTR(const std::string &model_file, const ModelScaling &scaling = ModelScaling());
 
         // States: x_0: c_A (concentration substance A) [mol/l], x_1: c_B (concentration substance B) [mol/l], x_2: theta (temperature in the reactor) [°C], x_3: theta_k (temperature in the cooling jacket) [°C]
         // Controls: u_0: V_dot/V_R (feed flow) [1/h], u_1: Q_dot_k (heat removal) [kJ/h]
@@ -44,10 +44,10 @@ namespace nmpc
 
     private:
         // Read parameters from yaml file
-        void ReadParams(const std::string &model_file);
+        void ReadParams(const std::string &model_file, const ModelScaling &scaling);
 
         // CSTR model parameters needed for the nonlinear system equations
-        ModelCSTRParams<T> model_params_;
+        ModelCSTRParams<typename ScalarType<T>::type> model_params_;
     };
 
 } // namespace nmpc
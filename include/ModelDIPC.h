@@ -34,16 +34,27 @@ namespace nmpc
         using SystemMatrices = std::array<T, 3>;
 
     public:
-        // Custom constructor: read DIPC parameters from the model file
-        ModelDIPC(const std::string &model_file);
+        // Custom constructor: read DIPC parameters from the model file, optionally scaled (e.g. for model-plant mismatch studies)
+        ModelDIPC(const std::string &model_file, const ModelScaling &scaling = ModelScaling());
 
         // States: x_0: cart position [m], x_1: bottom pendulum angles [rad], x_2: top pendulum angles [rad], x_3: cart velocity [m/s], x_4: bottom pendulum velocity [rad/s], x_5: top pendulum velocity [rad/s]
         // Controls: u: control force [N]
+        // Evaluated as x_dot_k = [x_2; D(x_1)\(H*u_k - C(x_1, x_2)*x_2 - G(x_1))] with a linear solve of the 3x3 mass matrix D
         T operator()(const T &x_k, const T &u_k) const override;
 
+        // Descriptor form with the mass matrix M(x_k) = diag(I, D(x_1)) and the right-hand side [x_2; H*u_k - C(x_1, x_2)*x_2 - G(x_1)]
+        bool descriptor_form() const override
+        {
+            return true;
+        }
+
+        T MassMatrix(const T &x_k) const override;
+
+        T RightHandSide(const T &x_k, const T &u_k) const override;
+
     private:
         // Read parameters from yaml file
-        void ReadParams(const std::string &model_file);
+        void ReadParams(const std::string &model_file, const ModelScaling &scaling);
 
         // Build system matrices needed for the nonlinear system equations in a compact matrix form
         SystemMatrices BuildSystemMatrices(const T &x1, const T &x2) const;
@@ -55,4 +66,24 @@ namespace nmpc
         T H_;
     };
 
+    template <int N>
+    class NativeVector;
+
+    // DIPC model class on native double vectors
+    // Evaluates the same nonlinear system equations with scalar operations and solves the 3x3 linear system of the mass matrix explicitly
+    template <int N>
+    class ModelDIPC<NativeVector<N>> : public ModelBase<NativeVector<N>>
+    {
+    public:
+        // Custom constructor: read DIPC parameters from the model file, optionally scaled (e.g. for model-plant mismatch studies)
+        ModelDIPC(const std::string &model_file, const ModelScaling &scaling = ModelScaling());
+
+        // States and controls as in the generic DIPC model class
+        NativeVector<N> operator()(const NativeVector<N> &x_k, const NativeVector<N> &u_k) const override;
+
+    private:
+        // DIPC model parameters needed for the nonlinear system equations
+        ModelParams<double> model_params_;
+    };
+
 } // namespace nmpc
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include <casadi/casadi.hpp>
+
+namespace nmpc
+{
+    // First shooting intervals of the control blocks: the first control_horizon intervals are covered with the block lengths of the
+    // move blocking pattern (one interval per block for an empty pattern), whose last length is repeated
+    inline std::vector<int> BlockStarts(int n_shoot, int control_horizon, const std::vector<int> &move_blocking)
+    {
+        const int n_c{std::min(std::max(control_horizon, 1), n_shoot)};
+        std::vector<int> block_start;
+        for (int i = 0, b = 0; i < n_c; b++)
+        {
+            block_start.push_back(i);
+            const int n_b{move_blocking.empty() ? 1 : move_blocking[std::min<std::size_t>(b, move_blocking.size() - 1)]};
+            i += std::max(n_b, 1);
+        }
+        return block_start;
+    }
+
+    // Sparse matrix (n_blocks x n_shoot), which maps the block controls to the controls of the shooting intervals: U = Uc*T_block
+    // The last block is held until the end of the prediction horizon
+    inline casadi::DM BlockingMatrix(const std::vector<int> &block_start, int n_shoot)
+    {
+        casadi::DM T_block = casadi::DM::zeros(block_start.size(), n_shoot);
+        for (int b = 0; b < static_cast<int>(block_start.size()); b++)
+        {
+            const int i_end{b + 1 < static_cast<int>(block_start.size()) ? block_start[b + 1] : n_shoot};
+            for (int i = block_start[b]; i < i_end; i++)
+            {
+                T_block(b, i) = 1;
+            }
+        }
+        return sparsify(T_block);
+    }
+
+    // Expand the block controls (nu x n_blocks, after the n_x state variables) of the NLP variables w to the controls of all
+    // shooting intervals, the remaining variables are kept
+    inline casadi::DM UnblockControls(const casadi::DM &w, int n_x, int nu, const casadi::DM &T_block)
+    {
+        const int n_blocks{static_cast<int>(T_block.size1())};
+        if (n_blocks == T_block.size2())
+        {
+            return w;
+        }
+        const int n_uc{nu * n_blocks};
+        const casadi::DM U = mtimes(reshape(w(casadi::Slice(n_x, n_x + n_uc)), nu, n_blocks), T_block);
+        return casadi::DM::veccat({w(casadi::Slice(0, n_x)), U, w(casadi::Slice(n_x + n_uc, w.size1()))});
+    }
+
+} // namespace nmpc
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <casadi/casadi.hpp>
+#include "Integrator.h"
+#include "ModelBase.h"
+#include "SolverFunction.h"
+
+namespace nmpc
+{
+    // Moving horizon estimator parameters from the config file
+    struct MHEParams
+    {
+        // Numerical solver for the NLP, e.g. IPOPT
+        std::string solver;
+        // Number of intervals of the estimation window (measurements of the last n_window samples, the arrival cost is at the first node)
+        int n_window;
+        // Sampling time of the measurements
+        double dt;
+        // Wall time budget of one NLP solve (no budget if zero), tolerance of the constraint violation for accepting a non-converged iterate
+        // and maximum number of solver iterations
+        double budget;
+        double feas_tol;
+        int max_iter;
+        // Number of dimensions of the state vector
+        int nx;
+        // Number of dimensions of the control vector
+        int nu;
+        // Output map: indices of the measured states
+        std::vector<int> y_index;
+        // Diagonals of the weighting matrices of the measurement residuals, the process noise and the arrival cost (inverse variances)
+        casadi::DM q_y;
+        casadi::DM q_w;
+        casadi::DM p_0;
+        // Initial guess of the state
+        casadi::DM x_0;
+        // Scaling factors for the state vector (same as for the OCP)
+        casadi::DM sc_x;
+        // State constraints of the estimates
+        casadi::DMDict x_const;
+        // Indices of the state constraints
+        std::vector<int> x_const_index;
+    };
+
+    // Statistics of the last MHE solution
+    struct EstimatorStats
+    {
+        // Number of solver iterations
+        int iter_count;
+        // Return status of the solver
+        std::string return_status;
+        bool success;
+    };
+
+    // Moving horizon estimator for partially measured states
+    // The states of a fixed-size window of the last n_window samples are estimated from the measured outputs and the applied controls.
+    // Deviations from the model are process noise, and the arrival cost at the first node summarizes the measurements, which left the window
+    // The NLP is built once, the window is shifted and the previous solution is used as warm start each sample
+    class MovingHorizonEstimator
+    {
+    public:
+        // Custom constructor: read the MHE parameters from the config file and build the NLP with the model and integrator of the controller
+        MovingHorizonEstimator(const std::string &config_file, const ModelBase<casadi::MX> &model, const Integrator<casadi::MX> &integrator);
+
+        // Clear the window and restart from the initial guess of the state (prior of the arrival cost)
+        void Reset(const casadi::DM &x_0);
+
+        // Add the measured outputs y of the current sample and the control u, which was applied since the previous sample,
+        // and estimate the current state
+        casadi::DM Update(const casadi::DM &y, const casadi::DM &u);
+
+        // Set the values of the runtime parameters of the model (model.runtime_parameters, in their order) without rebuilding the NLP
+        void SetModelParameters(const casadi::DM &theta);
+
+        // Get the current state estimate
+        inline casadi::DM x_hat() const
+        {
+            return X_sol_(casadi::Slice(), mhe_params_.n_window) / mhe_params_.sc_x;
+        }
+
+        // Get the estimated state trajectory of the window (nx x n_window + 1)
+        inline casadi::DM X_hat() const
+        {
+            return X_sol_ / repmat(mhe_params_.sc_x, 1, mhe_params_.n_window + 1);
+        }
+
+        // Get the indices of the measured states (output map)
+        inline const std::vector<int> &y_index() const
+        {
+            return mhe_params_.y_index;
+        }
+
+        // Get the number of measured outputs
+        inline int ny() const
+        {
+            return static_cast<int>(mhe_params_.y_index.size());
+        }
+
+        // Get the statistics of the last solution
+        inline const EstimatorStats &stats() const
+        {
+            return stats_;
+        }
+
+    private:
+        // Read parameters from yaml file
+        void ReadParams(const std::string &config_file);
+
+        // Build the NLP of the window and the persistent solver
+        void BuildMHE();
+
+        // Values of the NLP parameters [vec(Y); vec(U); x_bar; v; a; theta]
+        casadi::DM Parameters() const;
+
+        // MHE config parameters
+        MHEParams mhe_params_;
+        // Model and integrator of the controller
+        const ModelBase<casadi::MX> &model_;
+        const Integrator<casadi::MX> &integrator_;
+        // Discretized system dynamics of one sample (x_k, u_k, theta) -> x_k+1, including the scaling factors
+        casadi::Function F_;
+        // Persistent NLP solver and bounds of the constraints
+        SolverFunction solver_;
+        casadi::DM lbg_;
+        casadi::DM ubg_;
+        // Measurements and controls of the window, newest last (ny x n_window, nu x n_window)
+        casadi::DM Y_;
+        casadi::DM U_;
+        // Number of measurements in the window (n_window once the window is full)
+        int n_meas_;
+        // Prior of the arrival cost
+        casadi::DM x_bar_;
+        // Current values of the runtime parameters of the model
+        casadi::DM theta_val_;
+        // Solution (scaled states and process noise), warm start of the next sample
+        casadi::DM X_sol_;
+        casadi::DM W_sol_;
+        // Statistics of the last solution
+        EstimatorStats stats_;
+    };
+
+} // namespace nmpc
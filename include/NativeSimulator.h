@@ -0,0 +1,114 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <casadi/casadi.hpp>
+#include "Integrator.h"
+#include "ModelBase.h"
+#include "NativeVector.h"
+#include "Simulator.h"
+#include "ThreadPool.h"
+
+namespace nmpc
+{
+    // Simulation class for models and integrators instantiated on native double vectors with capacity N
+    // Simulates the real plant like the Simulator class, but without any heap allocation per time step
+    template <int N>
+    class NativeSimulator
+    {
+    public:
+        using Vector = NativeVector<N>;
+        // Creates a model with scaled model parameters (e.g. a perturbed plant of a batch simulation)
+        using ModelFactory = std::function<std::unique_ptr<ModelBase<Vector>>(const ModelScaling &scaling)>;
+
+        // Custom constructor: read the simulation parameters from the config file and initialize the model and integrator
+        NativeSimulator(const std::string &config_file, const ModelBase<Vector> &model, const Integrator<Vector> &integrator)
+            : sim_params_(ReadSimParams(config_file)), model_{model}, integrator_(integrator)
+        {
+        }
+
+        // Custom constructor: use the given simulation parameters and initialize the model and integrator
+        NativeSimulator(const SimParams &sim_params, const ModelBase<Vector> &model, const Integrator<Vector> &integrator)
+            : sim_params_(sim_params), model_{model}, integrator_(integrator)
+        {
+        }
+
+        // Simulate the model with the computed control input from the nmpc controller for the specified timestep
+        inline Vector ApplyControlForTimeStep(const Vector &x_k, const Vector &u_k) const
+        {
+            return integrator_(model_, sim_params_.dt, x_k, u_k);
+        }
+
+        // Simulate a batch of open-loop control sequences on a pool of sim.batch.n_threads worker threads
+        // Inputs: x_0 (initial states, nx x n_batch), u (control sequences, one column with the stacked controls u_0, ..., u_n_steps-1 per sample, nu*n_steps x n_batch)
+        // Optional: scaling (model parameter scaling per sample) and model_factory (creates the model for a scaling), otherwise every sample uses the simulator model
+        // Output: state trajectories in one contiguous buffer, the state x_k of sample b starts at index (b*(n_steps+1) + k)*nx
+        // Throws std::invalid_argument if the dimensions of u or scaling do not fit x_0 and n_steps, or a scaling is given without a model factory
+        std::vector<double> SimulateBatch(const casadi::DM &x_0, const casadi::DM &u, int n_steps, const std::vector<ModelScaling> &scaling = {},
+                                          const ModelFactory &model_factory = nullptr) const
+        {
+            const int nx{static_cast<int>(x_0.size1())};
+            const int n_batch{static_cast<int>(x_0.size2())};
+            const int nu{CheckBatchDimensions(x_0, u, n_steps, scaling.size(), static_cast<bool>(model_factory))};
+            const std::vector<double> x_0_data(x_0);
+            const std::vector<double> u_data(u);
+            std::vector<double> x_data(static_cast<std::size_t>(n_batch) * (n_steps + 1) * nx);
+            if (!pool_)
+            {
+                pool_.reset(new ThreadPool(sim_params_.n_threads));
+            }
+            pool_->ParallelFor(n_batch, [&](int b) {
+                std::unique_ptr<ModelBase<Vector>> scaled_model;
+                if (!scaling.empty())
+                {
+                    scaled_model = model_factory(scaling[b]);
+                }
+                const ModelBase<Vector> &model{scaled_model ? *scaled_model : model_};
+                double *x_b{&x_data[static_cast<std::size_t>(b) * (n_steps + 1) * nx]};
+                std::copy(&x_0_data[b * nx], &x_0_data[(b + 1) * nx], x_b);
+                Vector x_k(nx, 1);
+                Vector u_k(nu, 1);
+                std::copy(x_b, x_b + nx, x_k.data());
+                for (int k = 0; k < n_steps; k++)
+                {
+                    const double *u_bk{&u_data[(static_cast<std::size_t>(b) * n_steps + k) * nu]};
+                    std::copy(u_bk, u_bk + nu, u_k.data());
+                    x_k = integrator_(model, sim_params_.dt, x_k, u_k);
+                    std::copy(x_k.data(), x_k.data() + nx, x_b + (k + 1) * nx);
+                }
+            });
+            return x_data;
+        }
+
+        // Get the simulation start time
+        inline double t0() const
+        {
+            return sim_params_.t0;
+        }
+
+        // Get the simulation end time
+        inline double tf() const
+        {
+            return sim_params_.tf;
+        }
+
+        // Get the simulation step size
+        inline double dt() const
+        {
+            return sim_params_.dt;
+        }
+
+    private:
+        // Simulator config parameters
+        SimParams sim_params_;
+        // Specified model, which inherits from the abstract model base class
+        const ModelBase<Vector> &model_;
+        // Implemented integrator
+        const Integrator<Vector> &integrator_;
+        // Worker threads for batch simulations (started on first use)
+        mutable std::unique_ptr<ThreadPool> pool_;
+    };
+
+} // namespace nmpc
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <initializer_list>
+#include <vector>
+#include "ModelBase.h"
+
+namespace nmpc
+{
+    // Dense column vector of doubles with compile-time capacity N (no heap allocation)
+    // Provides the subset of the casadi::DM interface used by the models and integrators, so they can be instantiated on plain doubles
+    template <int N>
+    class NativeVector
+    {
+    public:
+        // Default constructor: zero vector of dimension N
+        NativeVector() : size_{N}
+        {
+            data_.fill(0.0);
+        }
+
+        // Zero vector of dimension rows*cols (same signature as the casadi matrix constructors)
+        NativeVector(int rows, int cols) : size_{rows * cols}
+        {
+            assert(size_ <= N);
+            data_.fill(0.0);
+        }
+
+        NativeVector(std::initializer_list<double> values) : size_{static_cast<int>(values.size())}
+        {
+            assert(size_ <= N);
+            data_.fill(0.0);
+            std::copy(values.begin(), values.end(), data_.begin());
+        }
+
+        explicit NativeVector(const std::vector<double> &values) : size_{static_cast<int>(values.size())}
+        {
+            assert(size_ <= N);
+            data_.fill(0.0);
+            std::copy(values.begin(), values.end(), data_.begin());
+        }
+
+        explicit operator std::vector<double>() const
+        {
+            return std::vector<double>(data_.begin(), data_.begin() + size_);
+        }
+
+        // Get the dimension of the vector
+        inline int size() const
+        {
+            return size_;
+        }
+
+        // Get the number of elements (same as casadi)
+        inline int numel() const
+        {
+            return size_;
+        }
+
+        inline double &operator()(int i)
+        {
+            return data_[i];
+        }
+
+        inline double operator()(int i) const
+        {
+            return data_[i];
+        }
+
+        inline double *data()
+        {
+            return data_.data();
+        }
+
+        inline const double *data() const
+        {
+            return data_.data();
+        }
+
+        inline NativeVector &operator+=(const NativeVector &other)
+        {
+            for (int i = 0; i < size_; i++)
+            {
+                data_[i] += other.data_[i];
+            }
+            return *this;
+        }
+
+        inline NativeVector &operator-=(const NativeVector &other)
+        {
+            for (int i = 0; i < size_; i++)
+            {
+                data_[i] -= other.data_[i];
+            }
+            return *this;
+        }
+
+        inline NativeVector &operator*=(double factor)
+        {
+            for (int i = 0; i < size_; i++)
+            {
+                data_[i] *= factor;
+            }
+            return *this;
+        }
+
+    private:
+        // Dimension of the vector
+        int size_;
+        // Elements of the vector
+        std::array<double, N> data_;
+    };
+
+    template <int N>
+    inline NativeVector<N> operator+(NativeVector<N> a, const NativeVector<N> &b)
+    {
+        return a += b;
+    }
+
+    template <int N>
+    inline NativeVector<N> operator-(NativeVector<N> a, const NativeVector<N> &b)
+    {
+        return a -= b;
+    }
+
+    template <int N>
+    inline NativeVector<N> operator-(NativeVector<N> a)
+    {
+        return a *= -1.0;
+    }
+
+    template <int N>
+    inline NativeVector<N> operator*(double factor, NativeVector<N> a)
+    {
+        return a *= factor;
+    }
+
+    template <int N>
+    inline NativeVector<N> operator*(NativeVector<N> a, double factor)
+    {
+        return a *= factor;
+    }
+
+    template <int N>
+    inline NativeVector<N> operator/(NativeVector<N> a, double divisor)
+    {
+        return a *= 1.0 / divisor;
+    }
+
+    // Scalar type of the model parameters for native vectors
+    template <int N>
+    struct ScalarType<NativeVector<N>>
+    {
+        using type = double;
+    };
+
+} // namespace nmpc
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <casadi/casadi.hpp>
+#include "ExplicitPolicy.h"
 #include "OptimalControlProblem.h"
+#include "SolverTelemetry.h"
 
 namespace nmpc
 {
@@ -11,12 +14,16 @@ namespace nmpc
     {
         // Required terminal state
         casadi::DM x_e;
+        // Indices of the required terminal state
+        std::vector<int> x_e_index;
         // Initial state
         casadi::DM x_0;
         // Number of dimensions of the state vector
         int nx;
         // Number of dimensions of the control vector
         int nu;
+        // Solution mode: "nlp" (fully converged NLP), "rti" (real-time iteration) or "explicit" (offline sampled policy with the NLP as fallback)
+        std::string mode;
     };
 
     // Generic NMPC class
@@ -26,19 +33,45 @@ namespace nmpc
         // Custom constructor: read the NMPC parameters from the config file and initialize the OCP
         NonlinearModelPredictiveControl(const std::string &config_file, const ModelBase<casadi::MX> &model, const Integrator<casadi::MX> &integrator);
 
+        // Copies share the built OCP and run as independent controllers (e.g. one per closed-loop scenario)
+        NonlinearModelPredictiveControl(const NonlinearModelPredictiveControl &) = default;
+
         // Solve the OCP and take the first value of the computed control trajectory
-        inline casadi::DM ComputeControlInput()
-        {
-            casadi::Slice all;
-            u_k_ = ocp_.Solve()(all, 0);
+        // In the real-time iteration mode, only the feedback phase is on the critical path, the preparation phase for the next sample follows it
+        // The phase timings and solver statistics of the sample are recorded in the telemetry
+        casadi::DM ComputeControlInput();
+
+        // Initialize the next OCP with the measured/simulated state vector
+        // In the explicit mode, the initialization (warm start) is deferred to the samples, in which the policy does not answer
+        void SetInitialCondition(const casadi::DM &x_meas);
 
-            return u_k_;
+        // Restart the controller from a new initial state without the previous solution
+        inline void Reset(const casadi::DM &x_0)
+        {
+            ocp_.Reset(x_0);
+            x_meas_ = x_0;
+            ocp_init_pending_ = false;
+            policy_answered_ = false;
+            t_init_wall_ = 0;
+            t_init_cpu_ = 0;
         }
 
-        // Initialize the next OCP with the measured/simulated state vector
-        inline void SetInitialCondition(const casadi::DM &x_meas)
+        // Update the reference between samples without rebuilding the OCP: a setpoint of the states x_e_index for all shooting nodes
+        // or a preview with one target for each shooting node (see OptimalControlProblem::SetReference)
+        // In the real-time iteration mode, the update takes effect with the next preparation phase. The explicit policy is sampled for the
+        // reference, the weights and the model parameters of the config files, so the controller solves the OCP online after an update
+        void SetReference(const casadi::DM &x_ref);
+
+        // Update the diagonals of the weighting matrices Q, R and P between samples without rebuilding the OCP
+        void SetWeights(const casadi::DM &q, const casadi::DM &r, const casadi::DM &p);
+
+        // Update the runtime parameters of the model between samples without rebuilding the OCP (e.g. from an online estimator)
+        void SetModelParameters(const casadi::DM &theta);
+
+        // Get the current values of the runtime parameters of the model
+        inline const casadi::DM &model_parameters() const
         {
-            ocp_.Init(x_meas);
+            return ocp_.model_parameters();
         }
 
         // Get the initial state
@@ -47,6 +80,18 @@ namespace nmpc
             return nmpc_params_.x_0;
         }
 
+        // Get the required terminal state (target of the last shooting node)
+        inline casadi::DM x_e() const
+        {
+            return nmpc_params_.x_e;
+        }
+
+        // Get the indices of the required terminal state
+        inline const std::vector<int> &x_e_index() const
+        {
+            return nmpc_params_.x_e_index;
+        }
+
         // Get the number of dimensions of the state vector
         inline int nx() const
         {
@@ -59,6 +104,18 @@ namespace nmpc
             return nmpc_params_.nu;
         }
 
+        // Get the statistics of the last OCP solution, including the origin of the control (solution, feasible iterate or fallback)
+        inline const SolverStats &stats() const
+        {
+            return ocp_.stats();
+        }
+
+        // Get the per-sample solver telemetry
+        inline const SolverTelemetry &telemetry() const
+        {
+            return telemetry_;
+        }
+
     private:
         // Read parameters from yaml file
         void ReadParams(const std::string &config_file);
@@ -69,6 +126,18 @@ namespace nmpc
         OptimalControlProblem ocp_;
         // Computed control input to apply to the plant
         casadi::DM u_k_;
+        // Per-sample solver telemetry
+        SolverTelemetry telemetry_;
+        // Explicit policy of the "explicit" mode
+        ExplicitPolicy policy_;
+        // Measured state of the current sample
+        casadi::DM x_meas_;
+        // Explicit mode: the OCP is not yet initialized with the measured state, and the policy answered since the last OCP solution
+        bool ocp_init_pending_{false};
+        bool policy_answered_{false};
+        // Wall and CPU time of the initialization (and RTI preparation) since the last sample, which is attributed to the next sample
+        double t_init_wall_{0};
+        double t_init_cpu_{0};
     };
 
 } // namespace nmpc
@@ -5,6 +5,8 @@
 #include <casadi/casadi.hpp>
 #include "Integrator.h"
 #include "ModelBase.h"
+#include "RiccatiSolver.h"
+#include "SolverFunction.h"
 
 namespace nmpc
 {
@@ -12,28 +14,80 @@ namespace nmpc
     // Optionally, scaling factors for the states and controls can be specified to avoid numerical problems when solving the NLP
     struct OCPParams
     {
-        // Numerical solver for the NLP, e.g. IPOPT
+        // Numerical solver for the NLP, e.g. IPOPT, or "riccati" for the built-in SQP with the Riccati QP solver
         std::string solver;
+        // Solution mode: "nlp" (fully converged NLP) or "rti" (real-time iteration)
+        std::string mode;
+        // QP solver for the real-time iteration, e.g. qrqp
+        std::string qp_solver;
+        // Number of full SQP iterations to initialize the real-time iteration
+        int n_init_iter;
+        // Hessian of the Lagrangian for IPOPT: "exact", "gauss_newton" (hessian of the least-squares cost functional, no second derivatives
+        // of the dynamics) or "limited_memory" (L-BFGS approximation of IPOPT)
+        std::string hessian;
+        // Warm start strategy: "none", "shift_hold", "shift_rollout" or "shift_lqr"
+        std::string warm_start;
+        // Reinject the multipliers of the previous solution (and use the warm start options of IPOPT)
+        bool warm_start_multipliers;
+        // Initial barrier parameter of IPOPT for warm started solves
+        double mu_init;
         // Number of shooting intervals
         int n_shoot;
+        // Number of intervals with free controls, the control of the last block is held until the end of the prediction horizon
+        int control_horizon;
+        // Move blocking: number of intervals over which each control is held (the last length is repeated, default: 1)
+        std::vector<int> move_blocking;
+        // Transcription of the dynamics: "multiple_shooting" (explicit integrator) or "collocation"
+        std::string transcription;
+        // Degree and scheme ("legendre" or "radau") of the collocation polynomials
+        int degree;
+        std::string scheme;
+        // Generate C code for the NLP functions and load them from a compiled shared library
+        bool codegen;
+        // Directory of the compiled shared libraries
+        std::string codegen_dir;
+        // Compiler and compiler flags for the generated code
+        std::string compiler;
+        std::string compiler_flags;
+        // Serialize the persistent NLP solver to a cache file and load it at startup instead of building the OCP (nlp mode)
+        bool cache;
+        // Directory of the cache files
+        std::string cache_dir;
+        // Hash of the contents of the config file (part of the key of the cache file)
+        std::size_t config_hash;
+        // Evaluation of the mapped shooting interval dynamics: "serial", "unroll" or "thread"
+        std::string parallelization;
+        // Number of worker threads for the "thread" parallelization
+        int n_threads;
+        // Wall time budget of one NLP solve (no budget if zero) and tolerance of the constraint violation for accepting a non-converged iterate
+        double budget;
+        double feas_tol;
+        // Maximum number of iterations and step tolerance of the Riccati SQP
+        int sqp_max_iter;
+        double sqp_tol;
+        // Maximum number of interior point iterations and tolerance of the Riccati QP solver
+        int riccati_max_iter;
+        double riccati_tol;
         // Number of dimensions of the state vector
         int nx;
         // Number of dimensions of the control vector
         int nu;
-        // Discretization step size
+        // Discretization step size of the first interval (sampling time of the controller)
         double dt;
-        // Required terminal state
-        casadi::MX x_e;
+        // Step sizes of the shooting intervals (non-uniform grid: fine near the present, coarse towards the terminal cost)
+        std::vector<double> dt_interval;
+        // Required terminal state (initial reference of all shooting nodes)
+        casadi::DM x_e;
         // Indices of the required terminal state
         std::vector<int> x_e_index;
         // Initial state
         casadi::DM x_0;
-        // Weighting matrix for the control trajectory
-        casadi::MX R;
-        // Weighting matrix for the state trajectory
-        casadi::MX Q;
-        // Weighting matrix for the terminal state
-        casadi::MX P;
+        // Diagonal of the weighting matrix for the control trajectory (initial value)
+        casadi::DM R;
+        // Diagonal of the weighting matrix for the state trajectory (initial value)
+        casadi::DM Q;
+        // Diagonal of the weighting matrix for the terminal state (initial value)
+        casadi::DM P;
         // Scaling factors for the state vector
         casadi::DM sc_x;
         // Scaling factors for the control vector
@@ -48,6 +102,31 @@ namespace nmpc
         std::vector<int> u_const_index;
     };
 
+    // Origin of the control trajectory of the last OCP solution
+    enum class ControlSource
+    {
+        // Converged solution
+        Solution,
+        // Feasible iterate of a solve, which stopped at the time budget or the iteration limit
+        FeasibleIterate,
+        // Previous control trajectory shifted by one interval (no feasible iterate or solver error)
+        Fallback
+    };
+
+    // Statistics of the last OCP solution
+    struct SolverStats
+    {
+        // Number of solver iterations (SQP iterations of the Riccati SQP, one QP of the real-time iteration)
+        int iter_count;
+        // Return status of the solver
+        std::string return_status;
+        bool success;
+        // Maximum constraint violation of the solution (of the linearization point for the real-time iteration)
+        double constr_viol;
+        // Origin of the returned control trajectory
+        ControlSource source;
+    };
+
     // Generic OCP class
     // This class needs the system dynamics, the control and state constraints, the initial and terminal states and the weighting matrices for the cost functional
     class OptimalControlProblem
@@ -56,50 +135,228 @@ namespace nmpc
         // Custom constructor: read the OCP parameters from the config file and initialize the model and integrator
         OptimalControlProblem(const std::string &config_file, const ModelBase<casadi::MX> &model, const Integrator<casadi::MX> &integrator);
 
+        // Copies share the built OCP (symbolic expressions and generated functions) and keep their own solution
+        // Each copy has its own instance of the NLP and QP solvers, so copies can be solved concurrently with correct statistics
+        OptimalControlProblem(const OptimalControlProblem &) = default;
+
         // Build the OCP
         void BuildOCP();
 
-        // Solve the OCP with direct multiple shooting
-        inline casadi::DM Solve()
+        // Solve the OCP with direct multiple shooting (one call of the persistent solver function)
+        // The solve stops at the time budget, then a feasible iterate or the shifted previous control trajectory is returned (see stats())
+        casadi::DM Solve();
+
+        // Initialize OCP for next time step with measured state vector and warm start it with the previous solution
+        void Init(const casadi::DM &x_0);
+
+        // Discard the previous solution and restart the OCP from the initial state vector (cold start)
+        void Reset(const casadi::DM &x_0);
+
+        // Real-time iteration preparation phase: shift the previous solution and linearize the OCP around it (no measurement needed)
+        // The solution is always shifted, with the warm start strategy "none" by holding the last state and control
+        void PrepareRTI();
+
+        // Real-time iteration feedback phase: solve the prepared QP for the measured state vector and take one Gauss-Newton step
+        casadi::DM FeedbackRTI();
+
+        // Set the reference of the states x_e_index without rebuilding the OCP: a setpoint for all shooting nodes (n_e x 1)
+        // or a preview with one target for each shooting node 1, ..., n_shoot (n_e x n_shoot, the last target is the terminal state)
+        void SetReference(const casadi::DM &x_ref);
+
+        // Set the diagonals of the weighting matrices Q, R and P without rebuilding the OCP
+        void SetWeights(const casadi::DM &q, const casadi::DM &r, const casadi::DM &p);
+
+        // Set the values of the runtime parameters of the model (model.runtime_parameters, in their order) without rebuilding the OCP
+        void SetModelParameters(const casadi::DM &theta);
+
+        // Get the values of the runtime parameters of the model
+        inline const casadi::DM &model_parameters() const
         {
-            const casadi::OptiSol sol = nlp_.solve();
-            X_sol_ = sol.value(X_);
-            U_sol_ = sol.value(U_);
-            return U_sol_ / ocp_params_.sc_u;
+            return theta_val_;
         }
 
-        // Initialize OCP for next time step with measured state vector
-        inline void Init(const casadi::DM &x_0)
+        // Get the statistics of the last solution
+        inline const SolverStats &stats() const
         {
-            nlp_.set_value(X_0_, ocp_params_.sc_x * x_0);
-            nlp_.set_initial(X_, X_sol_);
-            nlp_.set_initial(U_, U_sol_);
+            return stats_;
         }
 
+        // Hash of the discretized dynamics of one shooting interval (model parameters, integrator and scaling factors)
+        // and the current values of the runtime parameters, e.g. to identify data sampled from the OCP
+        std::size_t ModelHash() const;
+
     private:
         // Read parameters from yaml file
         void ReadParams(const std::string &config_file);
 
+        // Build the persistent solver function for the NLP formulated with the Opti stack
+        void BuildSolver();
+
+        // Build the linearization and the QP solver for the real-time iteration
+        void BuildRTI(const casadi::MX &X_next);
+
+        // Build the stage-wise linearization and the Riccati QP solver for the SQP (and the real-time iteration)
+        void BuildRiccati(const casadi::MX &X_next);
+
+        // Evaluate the stage-wise hessian of the cost functional for the current weights
+        void UpdateRiccatiHessian();
+
+        // Evaluate the stage-wise QP data at the current solution trajectories
+        void LinearizeRiccati();
+
+        // Solve the stage-wise QP for the measured state vector and take one Gauss-Newton step, returns the maximum norm of the step
+        // (infinity without a step if the QP solver fails)
+        double StepRiccati();
+
+        // Simple bounds of the decision variables w = [vec(X); vec(U)]
+        void BuildBounds();
+
+        // Step sizes of the mapped interval functions and the positions of the shifted nodes for the warm start on a non-uniform grid
+        void BuildGrid();
+
+        // Shift the trajectories one sample (first step size) forward in time, extended by the state x_next and the control u_N
+        // On a non-uniform grid, the states are interpolated linearly and the controls piecewise constant at the shifted nodes
+        void Shift(casadi::DM &X, casadi::DM &U, const casadi::DM &x_next, const casadi::DM &u_N) const;
+
+        // Blocks of the controls from the control horizon and the move blocking pattern
+        void BuildBlocking();
+
+        // Expand the controls of the blocks in the NLP decision variables to the full control trajectory
+        casadi::DM Unblock(const casadi::DM &w) const;
+
+        // Collocation equations and state at the end of one interval (x_k, xc_k, u_k, h_k, theta) -> (eq, x_k+1), including the scaling factors
+        casadi::Function BuildCollocation() const;
+
+        // Map the function of one shooting interval over all shooting intervals with the configured parallelization
+        casadi::Function Map(const casadi::Function &f) const;
+
+        // Evaluate the QP data at the current solution trajectories
+        void LinearizeRTI();
+
+        // Generate C code for the function, compile it to a shared library (if not already done) and return the library path
+        // For the NLP function, the code of all functions needed by the NLP solver is generated
+        std::string Compile(const casadi::Function &f, const casadi::Dict &solver_opts = casadi::Dict()) const;
+
+        // Path of the cache file of the persistent NLP solver for the current config, model and integrator
+        std::string CacheFile() const;
+
+        // Load the persistent NLP solver and the constraint bounds from the cache file, returns false if there is no valid cache file
+        bool LoadCache(const std::string &cache_file);
+
+        // Serialize the persistent NLP solver and the constraint bounds to the cache file
+        void SaveCache(const std::string &cache_file) const;
+
+        // Current values of the NLP parameters p = [X_0; vec(X_ref); q; r; p]
+        casadi::DM Parameters() const;
+
+        // Split the stacked decision variables w = [vec(X); vec(U)] into the solution trajectories
+        void SetSolution(const casadi::DM &w);
+
+        // Shift the previous primal-dual solution one shooting interval forward in time according to the warm start strategy
+        void WarmStart(const std::string &strategy);
+
+        // Terminal LQR control for the extension of the shifted control trajectory
+        casadi::DM TerminalControl(const casadi::DM &x_N, const casadi::DM &u_N);
+
+        // Keep the current solution trajectories as the last accepted solution
+        void Accept(ControlSource source);
+
+        // Replace the solution trajectories with the last accepted solution shifted by one interval
+        casadi::DM Fallback();
+
         // OCP config parameters
         OCPParams ocp_params_;
+        // Statistics of the last solution
+        SolverStats stats_{-1, "", false, 0, ControlSource::Solution};
         // Specified model, which inherits from the abstract model base class
         const ModelBase<casadi::MX> &model_;
         // Implemented integrator
         const Integrator<casadi::MX> &integrator_;
         // Constructed NLP using CasADi
         casadi::Opti nlp_;
+        // Persistent NLP solver function (x0, p, lbg, ubg, lam_x0, lam_g0) -> (x, lam_x, lam_g, ...)
+        SolverFunction solver_;
+        // Bounds of the NLP constraints
+        casadi::DM lbg_;
+        casadi::DM ubg_;
         // Solution trajectory of the state vector, which includes the scaling factors
         casadi::DM X_sol_;
         // Solution trajectory of the control vector, which includes the scaling factors
         casadi::DM U_sol_;
+        // Last accepted solution trajectories for the fallback
+        casadi::DM X_acc_;
+        casadi::DM U_acc_;
+        // Multipliers of the decision variable bounds and of the constraints of the previous solution
+        casadi::DM lam_x_;
+        casadi::DM lam_g_;
+        // Terminal LQR gain for the warm start
+        casadi::DM K_lqr_;
+        // Numerical weighting matrices (embedded in the full state vector) for the terminal LQR
+        casadi::DM Q_lqr_;
+        casadi::DM R_lqr_;
+        casadi::DM P_lqr_;
+        // Discretized system dynamics of one shooting interval (x_k, u_k, h_k, theta) -> x_k+1, including the scaling factors
+        casadi::Function F_;
+        // Jacobians of the discretized system dynamics (x_k, u_k, h_k, theta) -> (A, B)
+        casadi::Function F_jac_;
+        // Step sizes of the shooting intervals (row vector for the mapped interval functions)
+        casadi::DM H_;
+        // Positions of the nodes of the next sample on the current grid extended by one interval (empty for a uniform grid)
+        std::vector<double> shift_pos_;
         // Cost functional
         casadi::MX J_;
         // Discretized state (NLP state parameters)
         casadi::MX X_;
-        // Discretized control (NLP control parameters)
+        // Discretized control (expression of the controls of the blocks with move blocking)
         casadi::MX U_;
+        // Controls of the blocks (NLP control parameters)
+        casadi::MX Uc_;
+        // First interval of each block and blocking matrix U = Uc*T_block
+        std::vector<int> block_start_;
+        casadi::DM T_block_;
+        // States at the collocation points (NLP state parameters of the collocation transcription, nx x 0 otherwise)
+        casadi::MX Xc_;
+        // Solution of the states at the collocation points
+        casadi::DM Xc_sol_;
         // Initial state variable
         casadi::MX X_0_;
+        // References of the shooting nodes 1, ..., n_shoot (scaled) and diagonals of the weighting matrices (NLP parameters)
+        casadi::MX X_ref_;
+        casadi::MX q_;
+        casadi::MX r_;
+        casadi::MX p_;
+        // Runtime parameters of the model (NLP parameters)
+        casadi::MX theta_;
+        // All NLP parameters [X_0; vec(X_ref); q; r; p; theta]
+        casadi::MX P_nlp_;
+        // Current values of the references and the weights
+        casadi::DM X_ref_val_;
+        casadi::DM q_val_;
+        casadi::DM r_val_;
+        casadi::DM p_val_;
+        // Current values of the runtime parameters of the model
+        casadi::DM theta_val_;
+        // Measured initial state, which includes the scaling factors
+        casadi::DM x_meas_;
+        // Real-time iteration: linearization of the shooting gaps and cost functional
+        casadi::Function rti_lin_;
+        // Real-time iteration: QP solver for the Gauss-Newton step
+        SolverFunction rti_qp_;
+        // Bounds of the decision variables w = [vec(X); vec(U)] (real-time iteration and Riccati SQP)
+        casadi::DM lbw_;
+        casadi::DM ubw_;
+        // Real-time iteration: QP data prepared at the current linearization point
+        casadi::DM rti_g_;
+        casadi::DM rti_jac_g_;
+        casadi::DM rti_grad_J_;
+        casadi::DM rti_H_;
+        // Riccati SQP: linearization w -> (shooting gaps, stage-wise A and B, gradient of the cost functional)
+        casadi::Function ric_lin_;
+        // Riccati SQP: hessian of the cost functional (w, p) -> H, which is constant for given weights
+        casadi::Function ric_hess_;
+        // Riccati SQP: stage-wise QP data and QP solver
+        std::vector<RiccatiStage> ric_stages_;
+        RiccatiSolver riccati_;
     };
 
 } // namespace nmpc
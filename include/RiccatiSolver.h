@@ -0,0 +1,107 @@
+#pragma once
+
+#include <vector>
+
+namespace nmpc
+{
+    // Data of one stage of the QP, all matrices are dense and column-major
+    // Stage cost: 0.5*x'*Q*x + u'*S*x + 0.5*u'*R*u + q'*x + r'*u
+    // Dynamics: x_k+1 = A*x_k + B*u_k + c
+    // The terminal stage only uses Q and q
+    struct RiccatiStage
+    {
+        std::vector<double> Q;
+        std::vector<double> S;
+        std::vector<double> R;
+        std::vector<double> q;
+        std::vector<double> r;
+        std::vector<double> A;
+        std::vector<double> B;
+        std::vector<double> c;
+    };
+
+    // Riccati solver parameters
+    struct RiccatiParams
+    {
+        // Maximum number of interior point iterations
+        int max_iter;
+        // Tolerance of the KKT residuals and of the complementarity
+        double tol;
+    };
+
+    // Interior point solver for the stage-wise QP of a multiple shooting OCP with box bounds
+    //   min   sum_k stage cost(x_k, u_k) + terminal cost(x_N)
+    //   s.t.  x_k+1 = A_k*x_k + B_k*u_k + c_k, x_0 fixed, lbw <= w <= ubw
+    // with the stacked variables w = [x_0; ...; x_N; u_0; ...; u_N-1]
+    // Every Newton step (Mehrotra predictor-corrector) is computed by a Riccati recursion, so the cost is linear in the number of stages
+    class RiccatiSolver
+    {
+    public:
+        // Default constructor: empty solver (without stages)
+        RiccatiSolver() : RiccatiSolver(0, 0, 0, RiccatiParams{0, 0})
+        {
+        }
+
+        // Custom constructor: allocate the workspace for n_stages shooting intervals
+        RiccatiSolver(int nx, int nu, int n_stages, const RiccatiParams &params);
+
+        // Solve the QP for the initial state w(0:nx)
+        // w is the initial guess on input (it is moved into the interior of the bounds) and the solution on output
+        // Bounds of x_0 and infinite bounds are ignored
+        // Returns true if the KKT conditions are satisfied with the tolerance
+        bool Solve(const std::vector<RiccatiStage> &stages, const std::vector<double> &lbw, const std::vector<double> &ubw, std::vector<double> &w);
+
+        // Get the multipliers of the dynamics [pi_1; ...; pi_N] of the last solution
+        inline const std::vector<double> &pi() const
+        {
+            return pi_;
+        }
+
+        // Get the number of interior point iterations of the last solution
+        inline int iter() const
+        {
+            return iter_;
+        }
+
+        // Check if the last solution satisfies the KKT conditions with the tolerance
+        inline bool converged() const
+        {
+            return converged_;
+        }
+
+    private:
+        // Factorize the KKT system with the barrier hessian sigma_ added to the stage hessians
+        bool Factorize(const std::vector<RiccatiStage> &stages);
+
+        // Solve the factorized KKT system for the gradient grad and the dynamics residuals res
+        // The solution dw (with dw(0:nx) = 0) and the multipliers pi_new_ are stored in the workspace
+        void SolveKKT(const std::vector<RiccatiStage> &stages, const std::vector<double> &grad, const std::vector<double> &res);
+
+        // Dimensions
+        int nx_;
+        int nu_;
+        int n_stages_;
+        // Index of u_0 in the stacked variables
+        int n_x_;
+        RiccatiParams params_;
+        // Multipliers of the dynamics and of the lower and upper bounds
+        std::vector<double> pi_;
+        std::vector<double> lam_l_;
+        std::vector<double> lam_u_;
+        // Diagonal barrier hessian
+        std::vector<double> sigma_;
+        // Riccati factorization: cost-to-go hessians P_k, feedback gains K_k and cholesky factors of R_k + B_k'*P_k+1*B_k
+        std::vector<std::vector<double>> P_;
+        std::vector<std::vector<double>> K_;
+        std::vector<std::vector<double>> L_;
+        // Riccati solution: cost-to-go gradients p_k, feedforward terms and the Newton step
+        std::vector<std::vector<double>> p_;
+        std::vector<std::vector<double>> k_;
+        std::vector<double> dw_;
+        std::vector<double> pi_new_;
+        // Number of interior point iterations and convergence of the last solution
+        int iter_;
+        bool converged_;
+    };
+
+} // namespace nmpc
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <casadi/casadi.hpp>
+#include <yaml-cpp/yaml.h>
+#include "ModelBase.h"
+
+namespace nmpc
+{
+    // Runtime parameters declared in the model file (model.runtime_parameters) for model parameters of type S and models of type T
+    // Numeric models keep the values of the model file
+    template <typename S, typename T = S>
+    std::vector<RuntimeParameter<T>> MakeRuntimeParameters(const YAML::Node &, const std::map<std::string, S *> &)
+    {
+        return std::vector<RuntimeParameter<T>>();
+    }
+
+    // Symbolic models replace the values of the runtime parameters by symbols
+    template <>
+    inline std::vector<RuntimeParameter<casadi::MX>> MakeRuntimeParameters<casadi::MX, casadi::MX>(const YAML::Node &config, const std::map<std::string, casadi::MX *> &model_params)
+    {
+        std::vector<RuntimeParameter<casadi::MX>> runtime_parameters;
+        for (const std::string &name : config["model.runtime_parameters"].as<std::vector<std::string>>(std::vector<std::string>()))
+        {
+            const auto it = model_params.find(name);
+            if (it == model_params.end())
+            {
+                throw std::runtime_error("Unknown runtime parameter of the model: " + name);
+            }
+            runtime_parameters.push_back(RuntimeParameter<casadi::MX>{name, casadi::MX::sym(name), config[name].as<double>()});
+            *it->second = runtime_parameters.back().symbol;
+        }
+        return runtime_parameters;
+    }
+
+    // Symbols of the runtime parameters of a symbolic model (n_theta x 1)
+    inline casadi::MX RuntimeParameterSymbols(const ModelBase<casadi::MX> &model)
+    {
+        std::vector<casadi::MX> theta;
+        for (const RuntimeParameter<casadi::MX> &param : model.runtime_parameters())
+        {
+            theta.push_back(param.symbol);
+        }
+        return theta.empty() ? casadi::MX(0, 1) : casadi::MX::vertcat(theta);
+    }
+
+} // namespace nmpc
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include <casadi/casadi.hpp>
+
+namespace nmpc
+{
+    // Step sizes of n_shoot shooting intervals, starting with dt and growing geometrically by the factor growth from interval to interval
+    inline std::vector<double> GrowingStepSizes(double dt, double growth, int n_shoot)
+    {
+        std::vector<double> h(1, dt);
+        for (int i = 1; i < n_shoot; i++)
+        {
+            h.push_back(h.back() * growth);
+        }
+        return h;
+    }
+
+    // Positions of the nodes of the next sample (shifted by the first step size) on the shooting grid with the step sizes h,
+    // extended by one interval of the last step size: interval index plus the relative position in the interval (empty for a uniform grid)
+    inline std::vector<double> ShiftPositions(const std::vector<double> &h)
+    {
+        const int n_shoot{static_cast<int>(h.size())};
+        std::vector<double> shift_pos;
+        if (std::all_of(h.begin(), h.end(), [&](double h_i) { return h_i == h[0]; }))
+        {
+            return shift_pos;
+        }
+        // Node times of the grid, extended by one interval of the last step size
+        std::vector<double> t(n_shoot + 2, 0.0);
+        for (int i = 0; i <= n_shoot; i++)
+        {
+            t[i + 1] = t[i] + h[std::min(i, n_shoot - 1)];
+        }
+        for (int k = 0; k <= n_shoot; k++)
+        {
+            const double s{t[k] + h[0]};
+            int i{0};
+            while (i <= n_shoot && t[i + 1] <= s + 1e-9 * h[0])
+            {
+                i++;
+            }
+            shift_pos.push_back(i > n_shoot ? i : i + std::max(0.0, (s - t[i]) / (t[i + 1] - t[i])));
+        }
+        return shift_pos;
+    }
+
+    // Shift the state and control trajectories (nx x n_shoot+1, nu x n_shoot) one sample forward in time, extended by the state x_next
+    // and the control u_N. On a non-uniform grid (shift positions from ShiftPositions), the states are interpolated linearly
+    // and the controls piecewise constant at the shifted nodes
+    inline void ShiftTrajectories(const std::vector<double> &shift_pos, casadi::DM &X, casadi::DM &U, const casadi::DM &x_next, const casadi::DM &u_N)
+    {
+        casadi::Slice all;
+        const int n_shoot{static_cast<int>(U.size2())};
+        if (shift_pos.empty())
+        {
+            X = casadi::DM::horzcat({X(all, casadi::Slice(1, n_shoot + 1)), x_next});
+            U = casadi::DM::horzcat({U(all, casadi::Slice(1, n_shoot)), u_N});
+            return;
+        }
+        const casadi::DM X_ext = casadi::DM::horzcat({X, x_next});
+        const casadi::DM U_ext = casadi::DM::horzcat({U, u_N});
+        std::vector<casadi::DM> X_shift;
+        std::vector<casadi::DM> U_shift;
+        for (int k = 0; k <= n_shoot; k++)
+        {
+            const int i{static_cast<int>(shift_pos[k])};
+            const double f{shift_pos[k] - i};
+            X_shift.push_back(f > 0 ? (1 - f) * X_ext(all, i) + f * X_ext(all, i + 1) : X_ext(all, i));
+            if (k < n_shoot)
+            {
+                U_shift.push_back(U_ext(all, std::min(i, n_shoot)));
+            }
+        }
+        X = casadi::DM::horzcat(X_shift);
+        U = casadi::DM::horzcat(U_shift);
+    }
+
+    // Shift the constraint multipliers lam_g one shooting interval forward in time, each stage-wise block is extended by repeating its
+    // last interval. Layout of the constraints: shooting gaps (nx x n_shoot), stage constraints (n_stage x n_shoot, input and path
+    // constraints of each interval), initial condition (nx, not shifted), collocation equations (n_coll x n_shoot)
+    // Returns false and keeps the multipliers, if they do not have this layout
+    inline bool ShiftMultipliers(casadi::DM &lam_g, int nx, int n_shoot, int n_stage, int n_coll)
+    {
+        casadi::Slice all;
+        const int n_gap{nx * n_shoot};
+        const int i_0{n_gap + n_stage * n_shoot};
+        if (lam_g.size1() != i_0 + nx + n_coll * n_shoot || lam_g.size2() != 1)
+        {
+            return false;
+        }
+        const casadi::DM lam_gap = reshape(lam_g(casadi::Slice(0, n_gap)), nx, n_shoot);
+        const casadi::DM lam_stage = reshape(lam_g(casadi::Slice(n_gap, i_0)), n_stage, n_shoot);
+        const casadi::DM lam_coll = reshape(lam_g(casadi::Slice(i_0 + nx, i_0 + nx + n_coll * n_shoot)), n_coll, n_shoot);
+        lam_g = casadi::DM::veccat({casadi::DM::horzcat({lam_gap(all, casadi::Slice(1, n_shoot)), lam_gap(all, n_shoot - 1)}),
+                                    casadi::DM::horzcat({lam_stage(all, casadi::Slice(1, n_shoot)), lam_stage(all, n_shoot - 1)}),
+                                    lam_g(casadi::Slice(i_0, i_0 + nx)),
+                                    casadi::DM::horzcat({lam_coll(all, casadi::Slice(1, n_shoot)), lam_coll(all, n_shoot - 1)})});
+        return true;
+    }
+
+} // namespace nmpc
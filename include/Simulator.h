@@ -1,9 +1,13 @@
 #pragma once
 
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
 #include <casadi/casadi.hpp>
 #include "Integrator.h"
 #include "ModelBase.h"
+#include "ThreadPool.h"
 
 namespace nmpc
 {
@@ -16,12 +20,24 @@ namespace nmpc
         double tf;
         // Simulation step size
         double dt;
+        // Number of worker threads for batch simulations
+        int n_threads;
     };
 
+    // Read the simulation parameters from the config file
+    SimParams ReadSimParams(const std::string &config_file);
+
+    // Check the dimensions of a batch simulation (see Simulator::SimulateBatch), returns the number of controls nu
+    // Throws std::invalid_argument if the dimensions of u or scaling do not fit x_0 and n_steps, or a scaling is given without a model factory
+    int CheckBatchDimensions(const casadi::DM &x_0, const casadi::DM &u, int n_steps, std::size_t n_scaling, bool has_model_factory);
+
     // Simulation class simulates the real plant and supplies the nmpc controller with measurements
     class Simulator
     {
     public:
+        // Creates a model with scaled model parameters (e.g. a perturbed plant of a batch simulation)
+        using ModelFactory = std::function<std::unique_ptr<ModelBase<casadi::DM>>(const ModelScaling &scaling)>;
+
         // Custom constructor: read the simulation parameters from the config file and initialize the model and integrator
         Simulator(const std::string &config_file, const ModelBase<casadi::DM> &model, const Integrator<casadi::DM> &integrator);
 
@@ -31,6 +47,15 @@ namespace nmpc
             return integrator_(model_, sim_params_.dt, x_k, u_k);
         }
 
+        // Simulate a batch of open-loop control sequences on a pool of sim.batch.n_threads worker threads
+        // Inputs: x_0 (initial states, nx x n_batch), u (control sequences, one column with the stacked controls u_0, ..., u_n_steps-1 per sample, nu*n_steps x n_batch)
+        // Optional: scaling (model parameter scaling per sample) and model_factory (creates the model for a scaling), otherwise every sample uses the simulator model
+        // Output: state trajectories in one contiguous buffer, the state x_k of sample b starts at index (b*(n_steps+1) + k)*nx
+        // Throws std::invalid_argument if the dimensions of u or scaling do not fit x_0 and n_steps, or a scaling is given without a model factory
+        // (NativeSimulator::SimulateBatch is the allocation-free variant for native models)
+        std::vector<double> SimulateBatch(const casadi::DM &x_0, const casadi::DM &u, int n_steps, const std::vector<ModelScaling> &scaling = {},
+                                          const ModelFactory &model_factory = nullptr) const;
+
         // Get the simulation start time
         inline double t0() const
         {
@@ -59,6 +84,8 @@ namespace nmpc
         const ModelBase<casadi::DM> &model_;
         // Implemented integrator
         const Integrator<casadi::DM> &integrator_;
+        // Worker threads for batch simulations (started on first use)
+        mutable std::unique_ptr<ThreadPool> pool_;
     };
 
 } // namespace nmpc
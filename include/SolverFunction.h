@@ -0,0 +1,63 @@
+#pragma once
+
+#include <casadi/casadi.hpp>
+
+namespace nmpc
+{
+    // Solver function (NLP or QP solver of casadi) with its own instance in each copy
+    // The statistics of a casadi function are those of its first memory object, so they only belong to the last call if no other
+    // thread calls the same instance. Copies of an OCP are solved concurrently (ClosedLoopRunner, ExplicitPolicy::Sample),
+    // therefore a copy deserializes its own instance of the built solver instead of sharing it
+    class SolverFunction
+    {
+    public:
+        SolverFunction() = default;
+
+        SolverFunction(const casadi::Function &f) : f_{f}
+        {
+        }
+
+        SolverFunction(const SolverFunction &other) : f_{Clone(other.f_)}
+        {
+        }
+
+        SolverFunction &operator=(const SolverFunction &other)
+        {
+            f_ = Clone(other.f_);
+            return *this;
+        }
+
+        SolverFunction &operator=(const casadi::Function &f)
+        {
+            f_ = f;
+            return *this;
+        }
+
+        // Solve with the given inputs
+        inline casadi::DMDict operator()(const casadi::DMDict &arg) const
+        {
+            return f_(arg);
+        }
+
+        // Get the statistics of the last solve of this instance
+        inline casadi::Dict stats() const
+        {
+            return f_.stats();
+        }
+
+        // Get the solver function (e.g. for serialization)
+        inline const casadi::Function &function() const
+        {
+            return f_;
+        }
+
+    private:
+        static casadi::Function Clone(const casadi::Function &f)
+        {
+            return f.is_null() ? f : casadi::Function::deserialize(f.serialize());
+        }
+
+        casadi::Function f_;
+    };
+
+} // namespace nmpc
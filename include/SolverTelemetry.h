@@ -0,0 +1,144 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace nmpc
+{
+    // Telemetry parameters from the config file
+    struct TelemetryParams
+    {
+        // Number of samples kept in the ring buffer (older samples are overwritten)
+        int capacity;
+        // Deadline of the total computation time per sample (no deadline if zero)
+        double deadline;
+    };
+
+    // Read the telemetry parameters from the config file
+    TelemetryParams ReadTelemetryParams(const std::string &config_file);
+
+    // Telemetry record of one NMPC sample
+    struct SampleTelemetry
+    {
+        // Index of the sample
+        std::uint64_t sample;
+        // Wall and CPU time of the phases: initialization with the measurement (including the RTI preparation), solve and extraction of the control
+        double t_init_wall;
+        double t_init_cpu;
+        double t_solve_wall;
+        double t_solve_cpu;
+        double t_extract_wall;
+        double t_extract_cpu;
+        // Number of solver iterations, success flag and return status of the solver
+        int iter_count;
+        bool success;
+        std::array<char, 40> return_status;
+        // Maximum constraint violation of the solution
+        double constr_viol;
+        // Total computation time exceeded the deadline
+        bool deadline_miss;
+    };
+
+    // Latency percentiles over all recorded samples
+    struct LatencyPercentiles
+    {
+        double p50;
+        double p95;
+        double p99;
+        double max;
+    };
+
+    // Per-sample solver telemetry of the NMPC
+    // The controller thread records the samples into a lock-free single producer ring buffer and latency histograms,
+    // other threads can read them concurrently (samples overwritten while they are read are dropped). Each slot of the ring buffer
+    // is a seqlock: the sample is stored in atomic words and the sequence number of the slot is odd while the producer writes it
+    class SolverTelemetry
+    {
+    public:
+        // Custom constructor: read the telemetry parameters from the config file
+        explicit SolverTelemetry(const std::string &config_file);
+
+        // Custom constructor: use the given telemetry parameters
+        explicit SolverTelemetry(const TelemetryParams &telemetry_params);
+
+        // Copies start with an empty record (same parameters)
+        SolverTelemetry(const SolverTelemetry &other);
+        SolverTelemetry &operator=(const SolverTelemetry &) = delete;
+
+        // Record one sample (controller thread only), the sample index and the deadline miss are set here
+        void Record(SampleTelemetry sample);
+
+        // Get the samples which are still in the ring buffer (oldest first)
+        std::vector<SampleTelemetry> Samples() const;
+
+        // Latency percentiles of the total computation time and of the solve phase (resolution of the histogram bins, about 12%)
+        LatencyPercentiles Latency() const;
+        LatencyPercentiles SolveLatency() const;
+
+        // Write the samples in the ring buffer as CSV file
+        void WriteCSV(const std::string &file_name) const;
+
+        // Write the summary (percentiles, deadline misses) and the samples in the ring buffer as JSON file
+        void WriteJSON(const std::string &file_name) const;
+
+        // Get the last recorded sample (zero before the first sample)
+        SampleTelemetry last() const;
+
+        // Get the number of recorded samples
+        inline std::uint64_t n_samples() const
+        {
+            return n_samples_.load(std::memory_order_acquire);
+        }
+
+        // Get the number of samples, which exceeded the deadline
+        inline std::uint64_t deadline_misses() const
+        {
+            return deadline_misses_.load(std::memory_order_relaxed);
+        }
+
+        // Get the deadline of the total computation time per sample
+        inline double deadline() const
+        {
+            return telemetry_params_.deadline;
+        }
+
+    private:
+        // Log-spaced latency histogram from 1 us to 10 s (20 bins per decade) with an overflow bin
+        static constexpr int n_bins{141};
+        using Histogram = std::array<std::atomic<std::uint64_t>, n_bins>;
+
+        // Slot of the ring buffer: sequence number (odd while the sample is written) and the sample as atomic words
+        static constexpr int n_words{(sizeof(SampleTelemetry) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t)};
+        struct Slot
+        {
+            std::atomic<std::uint64_t> seq;
+            std::array<std::atomic<std::uint64_t>, n_words> words;
+        };
+
+        // Read the sample of a slot, returns false if the producer writes the slot concurrently
+        static bool Read(const Slot &slot, SampleTelemetry &sample);
+
+        // Add a latency to the histogram
+        static void Add(Histogram &histogram, double t);
+
+        // Percentiles of the histogram (upper bin edges)
+        LatencyPercentiles Percentiles(const Histogram &histogram, double max) const;
+
+        // Telemetry config parameters
+        TelemetryParams telemetry_params_;
+        // Ring buffer of the samples, the sample i is stored at index i % capacity
+        std::vector<Slot> buffer_;
+        // Number of recorded samples and of deadline misses
+        std::atomic<std::uint64_t> n_samples_;
+        std::atomic<std::uint64_t> deadline_misses_;
+        // Latency histograms and maximum latencies of the total computation time and the solve phase
+        Histogram latency_;
+        Histogram solve_latency_;
+        std::atomic<double> latency_max_;
+        std::atomic<double> solve_latency_max_;
+    };
+
+} // namespace nmpc
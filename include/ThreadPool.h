@@ -0,0 +1,71 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nmpc
+{
+    // Fixed-size pool of worker threads for data parallel loops
+    // Each worker owns a queue of loop indices and steals from the other queues when its own queue is empty,
+    // which balances loop bodies with very different run times (e.g. closed-loop simulations)
+    class ThreadPool
+    {
+    public:
+        // Custom constructor: start n_threads worker threads (at least one)
+        explicit ThreadPool(int n_threads);
+
+        // Stop and join the worker threads
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        // Call fn(i) for all i in [0, n) on the worker threads and wait until all calls are finished
+        // The first exception thrown by fn is rethrown in the calling thread, fn must not call ParallelFor of the same pool
+        void ParallelFor(int n, const std::function<void(int)> &fn);
+
+        // Get the number of worker threads
+        inline int n_threads() const
+        {
+            return static_cast<int>(workers_.size());
+        }
+
+    private:
+        // Loop indices of one worker
+        struct WorkQueue
+        {
+            std::mutex mutex;
+            std::deque<int> indices;
+        };
+
+        // Wait for parallel loops and execute their loop bodies until the pool is stopped
+        void WorkerLoop(int w);
+
+        // Take the next loop index of worker w from its own queue (front) or steal one from another queue (back)
+        bool NextIndex(int w, int &i);
+
+        // Worker threads and their queues
+        std::vector<std::thread> workers_;
+        std::vector<std::unique_ptr<WorkQueue>> queues_;
+        // Loop body of the current parallel loop
+        const std::function<void(int)> *fn_;
+        // Number of the current parallel loop, a change wakes up the workers
+        unsigned long generation_;
+        // Number of workers which still work on the current parallel loop
+        int n_busy_;
+        // Stop flag for the worker threads
+        bool stop_;
+        // First exception thrown by a loop body
+        std::exception_ptr exception_;
+        std::mutex mutex_;
+        std::condition_variable loop_started_;
+        std::condition_variable loop_done_;
+    };
+
+} // namespace nmpc
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <casadi/casadi.hpp>
+#include "ModelBase.h"
+
+namespace nmpc
+{
+    // Model with the time scaled by h, so one integration step of length 1 is a step of length h of the original model
+    // This allows integration steps of symbolic length, e.g. for non-uniform shooting grids or the prediction of computation delays
+    class TimeScaledModel : public ModelBase<casadi::MX>
+    {
+    public:
+        TimeScaledModel(const ModelBase<casadi::MX> &model, const casadi::MX &h) : model_(model), h_(h)
+        {
+        }
+
+        casadi::MX operator()(const casadi::MX &x_k, const casadi::MX &u_k) const override
+        {
+            return h_ * model_(x_k, u_k);
+        }
+
+        bool descriptor_form() const override
+        {
+            return model_.descriptor_form();
+        }
+
+        casadi::MX MassMatrix(const casadi::MX &x_k) const override
+        {
+            return model_.MassMatrix(x_k);
+        }
+
+        casadi::MX RightHandSide(const casadi::MX &x_k, const casadi::MX &u_k) const override
+        {
+            return h_ * model_.RightHandSide(x_k, u_k);
+        }
+
+    private:
+        const ModelBase<casadi::MX> &model_;
+        casadi::MX h_;
+    };
+
+} // namespace nmpc
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace nmpc
+{
+    // Trajectory recorder parameters from the config file
+    struct RecorderParams
+    {
+        // Number of records per block of the file (rounded up to a multiple of 512, so the blocks are page aligned)
+        int block_size;
+        // Interval of the background flushes
+        double flush_interval;
+    };
+
+    // Read the trajectory recorder parameters from the config file
+    RecorderParams ReadRecorderParams(const std::string &config_file);
+
+    // Records of a trajectory file, data[c][r] is column c of record r
+    struct Trajectory
+    {
+        std::vector<std::string> columns;
+        std::vector<std::vector<double>> data;
+    };
+
+    // Read all records of a trajectory file (also of a running or aborted recording up to its last flush)
+    Trajectory ReadTrajectory(const std::string &file_name);
+
+    // Streaming recorder of trajectories (time, states, controls, telemetry, ...) into a memory-mapped binary file
+    // File layout: header (magic, header size, number of columns, block size, number of records, column names), followed by
+    // blocks of block_size records in columnar layout (column c of the block is contiguous)
+    // Appending a record only writes to the mapped block, a background thread writes the finished blocks back and updates the number of records in the header
+    class TrajectoryRecorder
+    {
+    public:
+        // Custom constructor: read the recorder parameters from the config file and create the file with the column names
+        TrajectoryRecorder(const std::string &config_file, const std::string &file_name, const std::vector<std::string> &columns);
+
+        // Custom constructor: use the given recorder parameters
+        TrajectoryRecorder(const RecorderParams &recorder_params, const std::string &file_name, const std::vector<std::string> &columns);
+
+        // Flush all records and close the file
+        ~TrajectoryRecorder();
+
+        TrajectoryRecorder(const TrajectoryRecorder &) = delete;
+        TrajectoryRecorder &operator=(const TrajectoryRecorder &) = delete;
+
+        // Append one record with a value for each column, missing values are NaN (recording thread only)
+        void Append(const std::vector<double> &record);
+
+        // Get the number of appended records
+        inline std::uint64_t n_records() const
+        {
+            return n_records_.load(std::memory_order_acquire);
+        }
+
+        // Get the number of columns
+        inline int n_columns() const
+        {
+            return static_cast<int>(n_columns_);
+        }
+
+    private:
+        // Header at the beginning of the file, followed by the column names
+        struct Header
+        {
+            char magic[8];
+            std::uint64_t header_size;
+            std::uint64_t n_columns;
+            std::uint64_t block_size;
+            std::uint64_t n_records;
+        };
+
+        // Extend the file by one block and map it, returns the mapped block
+        double *MapBlock();
+
+        // Write back the finished blocks and update the header until the recorder is closed
+        void FlushLoop();
+
+        // Write back and unmap the finished blocks, write back the current block and update the number of records in the header
+        void Flush();
+
+        // File name, descriptor and layout
+        std::string file_name_;
+        int fd_;
+        std::uint64_t n_columns_;
+        std::uint64_t block_size_;
+        std::uint64_t header_size_;
+        std::uint64_t block_bytes_;
+        double flush_interval_;
+        // Mapped header and current block
+        Header *header_;
+        double *block_;
+        std::uint64_t n_blocks_;
+        // Number of appended records
+        std::atomic<std::uint64_t> n_records_;
+        // Finished blocks, which are written back and unmapped by the background thread
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::vector<double *> finished_;
+        bool stop_;
+        std::thread flusher_;
+    };
+
+} // namespace nmpc
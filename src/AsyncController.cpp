@@ -0,0 +1,148 @@
+#include <chrono>
+#include <cmath>
+#include "Config.h"
+#include "AsyncController.h"
+#include "RuntimeParameters.h"
+#include "TimeScaledModel.h"
+
+using casadi::DM;
+using casadi::MX;
+using std::vector;
+
+namespace nmpc
+{
+
+    AsyncController::AsyncController(const std::string &config_file, const ModelBase<MX> &model, const Integrator<MX> &integrator)
+        : nmpc_{config_file, model, integrator}, t_meas_{0}, has_measurement_{false}, stop_{false}, front_{0}, has_control_{false}
+    {
+        ReadParams(config_file);
+        delay_.store(async_params_.delay);
+
+        const MX x{MX::sym("x", nmpc_.nx())};
+        const MX u{MX::sym("u", nmpc_.nu())};
+        const MX h{MX::sym("h")};
+        const MX theta{RuntimeParameterSymbols(model)};
+        const TimeScaledModel scaled_model{model, h};
+        predict_ = casadi::Function("predict", {x, u, h, theta}, {integrator(scaled_model, 1.0, x, u)});
+
+        worker_ = std::thread(&AsyncController::WorkerLoop, this);
+    }
+
+    AsyncController::~AsyncController()
+    {
+        {
+            std::lock_guard<std::mutex> lock(measurement_mutex_);
+            stop_ = true;
+        }
+        measurement_cv_.notify_one();
+        worker_.join();
+    }
+
+    void AsyncController::ReadParams(const std::string &config_file)
+    {
+        const YAML::Node config = LoadConfig(config_file);
+        async_params_.compensate = config["nmpc.async.compensate"].as<bool>(true);
+        async_params_.delay = config["nmpc.async.delay"].as<double>(0);
+        async_params_.delay_filter = config["nmpc.async.delay_filter"].as<double>(0.2);
+        async_params_.time_scale = config["nmpc.async.time_scale"].as<double>(1);
+        // Step size of the first shooting interval for a non-uniform grid
+        const YAML::Node dt = config["ocp.dt"];
+        async_params_.dt = dt.IsSequence() ? dt[0].as<double>() : dt.as<double>();
+    }
+
+    void AsyncController::SetMeasurement(const DM &x_meas, double t_meas)
+    {
+        {
+            std::lock_guard<std::mutex> lock(measurement_mutex_);
+            x_meas_ = x_meas;
+            t_meas_ = t_meas;
+            has_measurement_ = true;
+        }
+        measurement_cv_.notify_one();
+    }
+
+    bool AsyncController::GetControl(AsyncControl &control) const
+    {
+        std::lock_guard<std::mutex> lock(control_mutex_);
+        if (exception_)
+        {
+            std::rethrow_exception(exception_);
+        }
+        if (has_control_)
+        {
+            control = control_[front_];
+        }
+        return has_control_;
+    }
+
+    void AsyncController::WorkerLoop()
+    {
+        try
+        {
+            while (true)
+            {
+                DM x_meas;
+                double t_meas;
+                {
+                    std::unique_lock<std::mutex> lock(measurement_mutex_);
+                    measurement_cv_.wait(lock, [this] { return has_measurement_ || stop_; });
+                    if (stop_)
+                    {
+                        return;
+                    }
+                    x_meas = x_meas_;
+                    t_meas = t_meas_;
+                    has_measurement_ = false;
+                }
+
+                // Predict the state at the time when the new control will be available, the plant applies the latest control until then
+                // (only the worker writes the control buffers, so it can read the front buffer without the lock)
+                // The delay is measured in wall-clock seconds and converted to model time here, everything below is in model time
+                const double delay{async_params_.compensate ? async_params_.time_scale * delay_.load(std::memory_order_relaxed) : 0};
+                const vector<double> u_applied{has_control_ ? control_[front_].u : vector<double>(nmpc_.nu(), 0)};
+                const auto t_start = std::chrono::steady_clock::now();
+                nmpc_.SetInitialCondition(Predict(x_meas, u_applied, delay));
+                const DM u_k{nmpc_.ComputeControlInput()};
+                const double t_comp{std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count()};
+                Publish(u_k, t_meas, t_meas + delay);
+
+                delay_.store((1 - async_params_.delay_filter) * delay_.load(std::memory_order_relaxed) + async_params_.delay_filter * t_comp, std::memory_order_relaxed);
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(control_mutex_);
+            exception_ = std::current_exception();
+        }
+    }
+
+    DM AsyncController::Predict(const DM &x, const vector<double> &u, double t) const
+    {
+        if (t <= 0)
+        {
+            return x;
+        }
+        // Steps of equal length, which are not longer than the discretization step size of the OCP
+        const int n_steps{static_cast<int>(std::ceil(t / async_params_.dt))};
+        DM x_pred{x};
+        for (int i = 0; i < n_steps; i++)
+        {
+            x_pred = predict_(std::vector<DM>{x_pred, DM(u), DM(t / n_steps), nmpc_.model_parameters()})[0];
+        }
+        return x_pred;
+    }
+
+    void AsyncController::Publish(const DM &u, double t_meas, double t_valid)
+    {
+        AsyncControl &back{control_[1 - front_]};
+        back.u = static_cast<vector<double>>(u);
+        back.t_meas = t_meas;
+        back.t_valid = t_valid;
+        back.sample = has_control_ ? control_[front_].sample + 1 : 0;
+
+        std::lock_guard<std::mutex> lock(control_mutex_);
+        front_ = 1 - front_;
+        has_control_ = true;
+    }
+
+} // namespace nmpc
@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <thread>
+#include "Config.h"
+#include "ClosedLoopRunner.h"
+
+namespace nmpc
+{
+
+    ClosedLoopParams ReadClosedLoopParams(const std::string &config_file)
+    {
+        ClosedLoopParams closed_loop_params;
+        const YAML::Node config = LoadConfig(config_file);
+        closed_loop_params.n_threads = config["closed_loop.n_threads"].as<int>(std::thread::hardware_concurrency());
+        return closed_loop_params;
+    }
+
+    ClosedLoopMetrics SummarizeClosedLoop(const std::vector<ClosedLoopResult> &results, double t_wall)
+    {
+        ClosedLoopMetrics metrics{};
+        metrics.n_scenarios = static_cast<int>(results.size());
+        metrics.t_wall = t_wall;
+        std::vector<double> t_nmpc;
+        for (const ClosedLoopResult &result : results)
+        {
+            t_nmpc.insert(t_nmpc.end(), result.t_nmpc.begin(), result.t_nmpc.end());
+            metrics.tracking_rms_mean += result.tracking_rms / results.size();
+            metrics.tracking_rms_max = std::max(metrics.tracking_rms_max, result.tracking_rms);
+        }
+        metrics.n_samples = static_cast<int>(t_nmpc.size());
+        if (t_nmpc.empty())
+        {
+            return metrics;
+        }
+        for (const double t : t_nmpc)
+        {
+            metrics.t_nmpc_mean += t / t_nmpc.size();
+            metrics.t_nmpc_max = std::max(metrics.t_nmpc_max, t);
+        }
+        std::vector<double>::iterator p95{t_nmpc.begin() + static_cast<long>(0.95 * (t_nmpc.size() - 1))};
+        std::nth_element(t_nmpc.begin(), p95, t_nmpc.end());
+        metrics.t_nmpc_p95 = *p95;
+        return metrics;
+    }
+
+    std::ostream &operator<<(std::ostream &os, const ClosedLoopMetrics &metrics)
+    {
+        os << "Closed loop: " << metrics.n_scenarios << " scenarios, " << metrics.n_samples << " samples in " << metrics.t_wall << " s" << std::endl;
+        os << "NMPC computation time per sample: mean " << 1e3 * metrics.t_nmpc_mean << " ms, p95 " << 1e3 * metrics.t_nmpc_p95 << " ms, max "
+           << 1e3 * metrics.t_nmpc_max << " ms" << std::endl;
+        os << "Tracking error (rms): mean " << metrics.tracking_rms_mean << ", max " << metrics.tracking_rms_max << std::endl;
+        return os;
+    }
+
+} // namespace nmpc
@@ -0,0 +1,62 @@
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include "Config.h"
+
+using std::string;
+
+namespace nmpc
+{
+
+    namespace
+    {
+        // Parsed config file and the hash of the parsed contents
+        struct ConfigEntry
+        {
+            std::size_t hash;
+            YAML::Node node;
+        };
+
+        std::mutex config_mutex;
+        std::map<string, ConfigEntry> config_cache;
+
+        string ReadText(const string &config_file)
+        {
+            std::ifstream file(config_file);
+            if (!file)
+            {
+                throw YAML::BadFile(config_file);
+            }
+            std::stringstream text;
+            text << file.rdbuf();
+            return text.str();
+        }
+    } // namespace
+
+    const YAML::Node LoadConfig(const std::string &config_file)
+    {
+        // Reading the file is cheap compared to parsing it, so the contents are compared on every call
+        const string text{ReadText(config_file)};
+        const std::size_t hash{std::hash<string>{}(text)};
+        std::lock_guard<std::mutex> lock(config_mutex);
+        auto it = config_cache.find(config_file);
+        if (it == config_cache.end() || it->second.hash != hash)
+        {
+            // The entry is replaced (assigning to the node would modify the nodes already handed out)
+            if (it != config_cache.end())
+            {
+                config_cache.erase(it);
+            }
+            it = config_cache.emplace(config_file, ConfigEntry{hash, YAML::Load(text)}).first;
+        }
+        return it->second.node;
+    }
+
+    std::size_t ConfigHash(const std::string &config_file)
+    {
+        return std::hash<string>{}(ReadText(config_file));
+    }
+
+} // namespace nmpc
@@ -0,0 +1,304 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include "Config.h"
+#include "ExplicitPolicy.h"
+#include "ThreadPool.h"
+
+using casadi::DM;
+using casadi::Slice;
+using std::vector;
+
+namespace nmpc
+{
+
+    namespace
+    {
+        // Identifier of the table file format
+        const char file_magic[8] = {'N', 'M', 'P', 'C', 'E', 'X', 'P', '2'};
+
+        // Config entries, which do not change the sampled OCP: the mode, the lookup of the table, the telemetry, the asynchronous controller,
+        // and the code generation, cache and map settings of the OCP
+        const char *const unsampled_keys[] = {"nmpc.mode", "nmpc.explicit.file", "nmpc.explicit.tol", "nmpc.explicit.n_threads", "nmpc.telemetry.",
+                                              "nmpc.async.", "ocp.codegen.", "ocp.cache.", "ocp.map."};
+
+        // Hash of the OCP and NMPC entries of the config file, which define the sampled OCP
+        std::size_t SampledConfigHash(const YAML::Node &config)
+        {
+            YAML::Node sampled;
+            for (const auto &entry : config)
+            {
+                const std::string key{entry.first.as<std::string>()};
+                bool is_sampled{key.compare(0, 4, "ocp.") == 0 || key.compare(0, 5, "nmpc.") == 0};
+                for (const char *unsampled : unsampled_keys)
+                {
+                    is_sampled = is_sampled && key.compare(0, std::strlen(unsampled), unsampled) != 0;
+                }
+                if (is_sampled)
+                {
+                    sampled[key] = YAML::Clone(entry.second);
+                }
+            }
+            return std::hash<std::string>{}(YAML::Dump(sampled));
+        }
+
+        template <typename T>
+        void Write(std::ofstream &file, const vector<T> &values)
+        {
+            file.write(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+        }
+
+        template <typename T>
+        void Read(std::ifstream &file, vector<T> &values, std::size_t n)
+        {
+            values.resize(n);
+            file.read(reinterpret_cast<char *>(values.data()), n * sizeof(T));
+        }
+    } // namespace
+
+    ExplicitPolicyParams ReadExplicitPolicyParams(const std::string &config_file)
+    {
+        ExplicitPolicyParams params;
+        const YAML::Node config = LoadConfig(config_file);
+        const int nx{config["nmpc.nx"].as<int>()};
+        params.file = config["nmpc.explicit.file"].as<std::string>("explicit_policy.bin");
+        params.n_grid = config["nmpc.explicit.n_grid"].as<vector<int>>(vector<int>(nx, 5));
+        params.tol = config["nmpc.explicit.tol"].as<double>(0.1);
+        params.n_threads = config["nmpc.explicit.n_threads"].as<int>(std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+        params.config_hash = SampledConfigHash(config);
+        // The box defaults to the state constraints, the unconstrained states need their range in the config file
+        params.x_min = vector<double>(nx, NAN);
+        params.x_max = vector<double>(nx, NAN);
+        const vector<int> x_index = config["ocp.con.x_index"].as<vector<int>>();
+        const vector<double> x_min = config["ocp.con.x_min"].as<vector<double>>();
+        const vector<double> x_max = config["ocp.con.x_max"].as<vector<double>>();
+        for (std::size_t c = 0; c < x_index.size(); c++)
+        {
+            params.x_min[x_index[c]] = x_min[c];
+            params.x_max[x_index[c]] = x_max[c];
+        }
+        params.x_min = config["nmpc.explicit.x_min"].as<vector<double>>(params.x_min);
+        params.x_max = config["nmpc.explicit.x_max"].as<vector<double>>(params.x_max);
+        if (static_cast<int>(params.n_grid.size()) != nx || static_cast<int>(params.x_min.size()) != nx || static_cast<int>(params.x_max.size()) != nx)
+        {
+            throw std::runtime_error("The explicit policy needs nmpc.explicit.n_grid, x_min and x_max for all states");
+        }
+        for (int i = 0; i < nx; i++)
+        {
+            if (!std::isfinite(params.x_min[i]) || !std::isfinite(params.x_max[i]) || params.x_min[i] >= params.x_max[i] || params.n_grid[i] < 2)
+            {
+                throw std::runtime_error("Invalid box of the explicit policy for state " + std::to_string(i) + " (nmpc.explicit.x_min, x_max, n_grid)");
+            }
+        }
+        return params;
+    }
+
+    ExplicitPolicy ExplicitPolicy::Sample(const OptimalControlProblem &ocp, const ExplicitPolicyParams &params)
+    {
+        ExplicitPolicy policy;
+        policy.config_hash_ = params.config_hash;
+        policy.model_hash_ = ocp.ModelHash();
+        policy.nx_ = static_cast<int>(params.n_grid.size());
+        policy.x_min_ = params.x_min;
+        policy.x_max_ = params.x_max;
+        policy.n_grid_ = params.n_grid;
+        policy.tol_ = params.tol;
+        policy.Index();
+        int n_points{1};
+        for (int n : params.n_grid)
+        {
+            n_points *= n;
+        }
+
+        // The OCP copies are made on the calling thread, each chunk of grid points is solved with its own copy
+        ThreadPool pool(params.n_threads);
+        const int n_chunks{std::min(n_points, 8 * pool.n_threads())};
+        vector<std::unique_ptr<OptimalControlProblem>> ocps;
+        for (int c = 0; c < n_chunks; c++)
+        {
+            ocps.emplace_back(new OptimalControlProblem(ocp));
+        }
+        vector<vector<double>> u(n_points);
+        policy.valid_.assign(n_points, 0);
+        pool.ParallelFor(n_chunks, [&](int c) {
+            OptimalControlProblem &ocp_c{*ocps[c]};
+            for (int p = c; p < n_points; p += n_chunks)
+            {
+                vector<double> x(policy.nx_);
+                for (int i = 0; i < policy.nx_; i++)
+                {
+                    const int k{(p / policy.stride_[i]) % policy.n_grid_[i]};
+                    x[i] = policy.x_min_[i] + (policy.x_max_[i] - policy.x_min_[i]) * k / (policy.n_grid_[i] - 1);
+                }
+                ocp_c.Reset(DM(x));
+                const DM U{ocp_c.Solve()};
+                u[p] = static_cast<vector<double>>(U(Slice(), 0));
+                policy.valid_[p] = ocp_c.stats().success && ocp_c.stats().source == ControlSource::Solution;
+            }
+        });
+
+        policy.nu_ = static_cast<int>(u[0].size());
+        policy.u_.reserve(n_points * policy.nu_);
+        for (const vector<double> &u_p : u)
+        {
+            policy.u_.insert(policy.u_.end(), u_p.begin(), u_p.end());
+        }
+        policy.Index();
+        return policy;
+    }
+
+    ExplicitPolicy ExplicitPolicy::Load(const ExplicitPolicyParams &params, std::size_t model_hash)
+    {
+        std::ifstream file(params.file, std::ios::binary);
+        char magic[sizeof(file_magic)];
+        if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, file_magic, sizeof(magic)) != 0)
+        {
+            throw std::runtime_error("No explicit policy table (generate it with nmpc_explicit): " + params.file);
+        }
+        // A table of another config or model would answer with the controls of a different OCP
+        std::uint64_t hashes[2];
+        file.read(reinterpret_cast<char *>(hashes), sizeof(hashes));
+        if (!file || hashes[0] != params.config_hash || hashes[1] != model_hash)
+        {
+            throw std::runtime_error("The explicit policy table was sampled with a different config or model (regenerate it with nmpc_explicit): " + params.file);
+        }
+        ExplicitPolicy policy;
+        policy.config_hash_ = params.config_hash;
+        policy.model_hash_ = model_hash;
+        std::int32_t dims[2];
+        file.read(reinterpret_cast<char *>(dims), sizeof(dims));
+        policy.nx_ = dims[0];
+        policy.nu_ = dims[1];
+        vector<std::int32_t> n_grid;
+        Read(file, n_grid, policy.nx_);
+        policy.n_grid_.assign(n_grid.begin(), n_grid.end());
+        Read(file, policy.x_min_, policy.nx_);
+        Read(file, policy.x_max_, policy.nx_);
+        int n_points{1};
+        for (int n : policy.n_grid_)
+        {
+            n_points *= n;
+        }
+        Read(file, policy.u_, static_cast<std::size_t>(n_points) * policy.nu_);
+        Read(file, policy.valid_, n_points);
+        if (!file)
+        {
+            throw std::runtime_error("Incomplete explicit policy table: " + params.file);
+        }
+        policy.tol_ = params.tol;
+        policy.Index();
+        return policy;
+    }
+
+    void ExplicitPolicy::Save(const std::string &file_name) const
+    {
+        std::ofstream file(file_name, std::ios::binary);
+        file.write(file_magic, sizeof(file_magic));
+        const std::uint64_t hashes[2] = {config_hash_, model_hash_};
+        file.write(reinterpret_cast<const char *>(hashes), sizeof(hashes));
+        const std::int32_t dims[2] = {nx_, nu_};
+        file.write(reinterpret_cast<const char *>(dims), sizeof(dims));
+        Write(file, vector<std::int32_t>(n_grid_.begin(), n_grid_.end()));
+        Write(file, x_min_);
+        Write(file, x_max_);
+        Write(file, u_);
+        Write(file, valid_);
+        if (!file)
+        {
+            throw std::runtime_error("Cannot write the explicit policy table: " + file_name);
+        }
+    }
+
+    bool ExplicitPolicy::Evaluate(const vector<double> &x, vector<double> &u) const
+    {
+        if (nx_ == 0 || static_cast<int>(x.size()) != nx_)
+        {
+            return false;
+        }
+        // Grid cell of x and the relative position of x in the cell
+        int base{0};
+        vector<double> frac(nx_);
+        for (int i = 0; i < nx_; i++)
+        {
+            if (!(x[i] >= x_min_[i] && x[i] <= x_max_[i]))
+            {
+                return false;
+            }
+            const double s{(x[i] - x_min_[i]) / (x_max_[i] - x_min_[i]) * (n_grid_[i] - 1)};
+            const int k{std::min(static_cast<int>(s), n_grid_[i] - 2)};
+            frac[i] = s - k;
+            base += k * stride_[i];
+        }
+        // Multilinear interpolation over the 2^nx corners of the cell
+        u.assign(nu_, 0.0);
+        vector<double> u_lo(nu_, INFINITY);
+        vector<double> u_hi(nu_, -INFINITY);
+        for (int v = 0; v < (1 << nx_); v++)
+        {
+            int p{base};
+            double w{1};
+            for (int i = 0; i < nx_; i++)
+            {
+                const bool upper{((v >> i) & 1) != 0};
+                p += upper ? stride_[i] : 0;
+                w *= upper ? frac[i] : 1 - frac[i];
+            }
+            if (!valid_[p])
+            {
+                return false;
+            }
+            for (int j = 0; j < nu_; j++)
+            {
+                const double u_pj{u_[p * nu_ + j]};
+                u[j] += w * u_pj;
+                u_lo[j] = std::min(u_lo[j], u_pj);
+                u_hi[j] = std::max(u_hi[j], u_pj);
+            }
+        }
+        // Quality check: large control jumps within a cell (e.g. active set changes) are not resolved by the grid
+        for (int j = 0; j < nu_; j++)
+        {
+            if (u_hi[j] - u_lo[j] > tol_ * u_range_[j])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int ExplicitPolicy::n_valid() const
+    {
+        return static_cast<int>(std::count(valid_.begin(), valid_.end(), 1));
+    }
+
+    void ExplicitPolicy::Index()
+    {
+        stride_.assign(nx_, 1);
+        for (int i = 1; i < nx_; i++)
+        {
+            stride_[i] = stride_[i - 1] * n_grid_[i - 1];
+        }
+        u_range_.assign(nu_, 0.0);
+        for (int j = 0; j < nu_; j++)
+        {
+            double u_lo{INFINITY};
+            double u_hi{-INFINITY};
+            for (int p = 0; p < n_points(); p++)
+            {
+                if (valid_[p])
+                {
+                    u_lo = std::min(u_lo, u_[p * nu_ + j]);
+                    u_hi = std::max(u_hi, u_[p * nu_ + j]);
+                }
+            }
+            u_range_[j] = u_hi > u_lo ? u_hi - u_lo : 0;
+        }
+    }
+
+} // namespace nmpc
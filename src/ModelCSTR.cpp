@@ -1,7 +1,9 @@
 #include <math.h>
 #include <casadi/casadi.hpp>
-#include <yaml-cpp/yaml.h>
+#include "Config.h"
 #include "ModelCSTR.h"
+#include "NativeVector.h"
+#include "RuntimeParameters.h"
 
 using casadi::DM;
 using casadi::MX;
@@ -11,9 +13,9 @@ namespace nmpc
 {
 
     template <typename T>
-    ModelCSTR<T>::ModelCSTR(const std::string &model_file)
+    ModelCSTR<T>::ModelCSTR(const std::string &model_file, const ModelScaling &scaling)
     {
-        ReadParams(model_file);
+        ReadParams(model_file, scaling);
         // Steady state parameters at the optimal operating point
         model_params_.c_A0 = 5.1;
         model_params_.theta_0 = 104.9;
@@ -23,10 +25,11 @@ namespace nmpc
     T ModelCSTR<T>::operator()(const T &x_k, const T &u_k) const
     {
         // Reaction velocities k_i depend on the temperature via the arrhenius law
+        using S = typename ScalarType<T>::type;
         const float temperature{273.15};
-        T k1 = model_params_.k_10 * exp(model_params_.E_1 / (x_k(2) + temperature));
-        T k2 = model_params_.k_20 * exp(model_params_.E_2 / (x_k(2) + temperature));
-        T k3 = model_params_.k_30 * exp(model_params_.E_3 / (x_k(2) + temperature));
+        S k1 = model_params_.k_10 * exp(model_params_.E_1 / (x_k(2) + temperature));
+        S k2 = model_params_.k_20 * exp(model_params_.E_2 / (x_k(2) + temperature));
+        S k3 = model_params_.k_30 * exp(model_params_.E_3 / (x_k(2) + temperature));
 
         // The dynamics of the reactor are derived from component balances for substances A and B and from energy balances for the reactor and cooling jacket
         T dx_(4, 1);
@@ -39,10 +42,14 @@ namespace nmpc
     }
 
     template <typename T>
-    void ModelCSTR<T>::ReadParams(const std::string &model_file)
+    void ModelCSTR<T>::ReadParams(const std::string &model_file, const ModelScaling &scaling)
     {
         // Physico-chemical parameters for the CSTR (most parameters are only known within bounds)
-        YAML::Node config = YAML::LoadFile(model_file);
+        YAML::Node config = YAML::Clone(LoadConfig(model_file));
+        for (const auto &factor : scaling)
+        {
+            config[factor.first] = config[factor.first].as<double>() * factor.second;
+        }
         model_params_.k_10 = config["model.k_10"].as<double>();
         model_params_.k_20 = config["model.k_20"].as<double>();
         model_params_.k_30 = config["model.k_30"].as<double>();
@@ -59,9 +66,27 @@ namespace nmpc
         model_params_.V_R = config["model.V_R"].as<double>();
         model_params_.m_K = config["model.m_K"].as<double>();
         model_params_.C_PK = config["model.C_PK"].as<double>();
+        // Declared runtime parameters become symbols of the symbolic model
+        this->runtime_parameters_ = MakeRuntimeParameters<typename ScalarType<T>::type, T>(config, {{"model.k_10", &model_params_.k_10},
+                                                                                                    {"model.k_20", &model_params_.k_20},
+                                                                                                    {"model.k_30", &model_params_.k_30},
+                                                                                                    {"model.E_1", &model_params_.E_1},
+                                                                                                    {"model.E_2", &model_params_.E_2},
+                                                                                                    {"model.E_3", &model_params_.E_3},
+                                                                                                    {"model.dH_AB", &model_params_.dH_AB},
+                                                                                                    {"model.dH_BC", &model_params_.dH_BC},
+                                                                                                    {"model.dH_AD", &model_params_.dH_AD},
+                                                                                                    {"model.rho", &model_params_.rho},
+                                                                                                    {"model.C_p", &model_params_.C_p},
+                                                                                                    {"model.k_w", &model_params_.k_w},
+                                                                                                    {"model.A_R", &model_params_.A_R},
+                                                                                                    {"model.V_R", &model_params_.V_R},
+                                                                                                    {"model.m_K", &model_params_.m_K},
+                                                                                                    {"model.C_PK", &model_params_.C_PK}});
     }
 
     template class ModelCSTR<DM>;
     template class ModelCSTR<MX>;
+    template class ModelCSTR<NativeVector<4>>;
 
 } // namespace nmpc
@@ -1,6 +1,8 @@
 #include <casadi/casadi.hpp>
-#include <yaml-cpp/yaml.h>
+#include "Config.h"
 #include "ModelDIPC.h"
+#include "NativeVector.h"
+#include "RuntimeParameters.h"
 
 using casadi::DM;
 using casadi::MX;
@@ -9,20 +11,62 @@ using casadi::Slice;
 namespace nmpc
 {
 
-    template <typename T>
-    ModelDIPC<T>::ModelDIPC(const std::string &model_file) : H_(3, 1)
+    namespace
+    {
+        // Solve the linear system of the mass matrix (symmetric positive definite)
+        // For casadi::MX, the linear solver plugin creates a single linear solver node, which factorizes the matrix numerically
+        // (without a plugin, casadi expands a symbolic QR decomposition into the graph)
+        MX SolveMassMatrix(const MX &D, const MX &b)
+        {
+            return solve(D, b, "ldl", casadi::Dict());
+        }
+
+        DM SolveMassMatrix(const DM &D, const DM &b)
+        {
+            return solve(D, b);
+        }
+    } // namespace
+
+    // Read the cart and pendulum parameters from the model file and compute the matrix entries, returns the runtime parameters of the model
+    template <typename S>
+    std::vector<RuntimeParameter<S>> ReadModelParams(const std::string &model_file, const ModelScaling &scaling, ModelParams<S> &model_params)
     {
-        ReadParams(model_file);
+        // Cart and pendulum parameters
+        YAML::Node config = YAML::Clone(LoadConfig(model_file));
+        for (const auto &factor : scaling)
+        {
+            config[factor.first] = config[factor.first].as<double>() * factor.second;
+        }
+        model_params.g = config["model.g"].as<double>();
+        model_params.m_0 = config["model.m_0"].as<double>();
+        model_params.m_1 = config["model.m_1"].as<double>();
+        model_params.m_2 = config["model.m_2"].as<double>();
+        model_params.L_1 = config["model.L_1"].as<double>();
+        model_params.L_2 = config["model.L_2"].as<double>();
+        // Declared runtime parameters become symbols of the symbolic model (before the matrix entries are derived from them)
+        std::vector<RuntimeParameter<S>> runtime_parameters{MakeRuntimeParameters<S>(config, {{"model.g", &model_params.g},
+                                                                                               {"model.m_0", &model_params.m_0},
+                                                                                               {"model.m_1", &model_params.m_1},
+                                                                                               {"model.m_2", &model_params.m_2},
+                                                                                               {"model.L_1", &model_params.L_1},
+                                                                                               {"model.L_2", &model_params.L_2}})};
 
         // Matrix entries (for more details see the paper: Optimal Control of a Double Inverted Pendulum on a Cart)
-        model_params_.d_1 = model_params_.m_0 + model_params_.m_1 + model_params_.m_2;
-        model_params_.d_2 = (model_params_.m_1 / 2 + model_params_.m_2) * model_params_.L_1;
-        model_params_.d_3 = model_params_.m_2 * model_params_.L_2 / 2;
-        model_params_.d_4 = (model_params_.m_1 / 3 + model_params_.m_2) * pow(model_params_.L_1, 2);
-        model_params_.d_5 = model_params_.m_2 * model_params_.L_1 * model_params_.L_2 / 2;
-        model_params_.d_6 = model_params_.m_2 * pow(model_params_.L_2, 2) / 3;
-        model_params_.f_1 = (model_params_.m_1 / 2 + model_params_.m_2) * model_params_.L_1 * model_params_.g;
-        model_params_.f_2 = model_params_.m_2 * model_params_.L_2 * model_params_.g / 2;
+        model_params.d_1 = model_params.m_0 + model_params.m_1 + model_params.m_2;
+        model_params.d_2 = (model_params.m_1 / 2 + model_params.m_2) * model_params.L_1;
+        model_params.d_3 = model_params.m_2 * model_params.L_2 / 2;
+        model_params.d_4 = (model_params.m_1 / 3 + model_params.m_2) * pow(model_params.L_1, 2);
+        model_params.d_5 = model_params.m_2 * model_params.L_1 * model_params.L_2 / 2;
+        model_params.d_6 = model_params.m_2 * pow(model_params.L_2, 2) / 3;
+        model_params.f_1 = (model_params.m_1 / 2 + model_params.m_2) * model_params.L_1 * model_params.g;
+        model_params.f_2 = model_params.m_2 * model_params.L_2 * model_params.g / 2;
+        return runtime_parameters;
+    }
+
+    template <typename T>
+    ModelDIPC<T>::ModelDIPC(const std::string &model_file, const ModelScaling &scaling) : H_(3, 1)
+    {
+        ReadParams(model_file, scaling);
 
         H_(0) = 1;
         H_(1) = 0;
@@ -70,26 +114,80 @@ namespace nmpc
         const T &x2 = x_k(Slice(3, 6));
         auto sys_mat{BuildSystemMatrices(x1, x2)};
         // Nonlinear system equations in compact matrix form derived from the Lagrange equations
+        // The mass matrix is not inverted symbolically: for casadi::MX the linear solve is one node, which is evaluated numerically
         T dx_(6, 1);
         dx_(Slice(0, 3)) = x2;
-        dx_(Slice(3, 6)) = mtimes(inv(sys_mat[0]), (H_ * u_k - mtimes(sys_mat[1], x2) - sys_mat[2]));
+        dx_(Slice(3, 6)) = SolveMassMatrix(sys_mat[0], H_ * u_k - mtimes(sys_mat[1], x2) - sys_mat[2]);
         return dx_;
     }
 
     template <typename T>
-    void ModelDIPC<T>::ReadParams(const std::string &model_file)
+    T ModelDIPC<T>::MassMatrix(const T &x_k) const
     {
-        // Cart and pendulum parameters
-        YAML::Node config = YAML::LoadFile(model_file);
-        model_params_.g = config["model.g"].as<double>();
-        model_params_.m_0 = config["model.m_0"].as<double>();
-        model_params_.m_1 = config["model.m_1"].as<double>();
-        model_params_.m_2 = config["model.m_2"].as<double>();
-        model_params_.L_1 = config["model.L_1"].as<double>();
-        model_params_.L_2 = config["model.L_2"].as<double>();
+        const T &x1 = x_k(Slice(0, 3));
+        const T &x2 = x_k(Slice(3, 6));
+        return T::diagcat({T::eye(3), BuildSystemMatrices(x1, x2)[0]});
+    }
+
+    template <typename T>
+    T ModelDIPC<T>::RightHandSide(const T &x_k, const T &u_k) const
+    {
+        const T &x1 = x_k(Slice(0, 3));
+        const T &x2 = x_k(Slice(3, 6));
+        auto sys_mat{BuildSystemMatrices(x1, x2)};
+        T f_(6, 1);
+        f_(Slice(0, 3)) = x2;
+        f_(Slice(3, 6)) = H_ * u_k - mtimes(sys_mat[1], x2) - sys_mat[2];
+        return f_;
+    }
+
+    template <typename T>
+    void ModelDIPC<T>::ReadParams(const std::string &model_file, const ModelScaling &scaling)
+    {
+        this->runtime_parameters_ = ReadModelParams(model_file, scaling, model_params_);
+    }
+
+    template <int N>
+    ModelDIPC<NativeVector<N>>::ModelDIPC(const std::string &model_file, const ModelScaling &scaling)
+    {
+        ReadModelParams(model_file, scaling, model_params_);
+    }
+
+    template <int N>
+    NativeVector<N> ModelDIPC<NativeVector<N>>::operator()(const NativeVector<N> &x_k, const NativeVector<N> &u_k) const
+    {
+        // Symmetric matrix D and right hand side H*u - C*x2 - G of the system equations
+        const double d_01{model_params_.d_2 * cos(x_k(1))};
+        const double d_02{model_params_.d_3 * cos(x_k(2))};
+        const double d_12{model_params_.d_5 * cos(x_k(1) - x_k(2))};
+        const double d_00{model_params_.d_1};
+        const double d_11{model_params_.d_4};
+        const double d_22{model_params_.d_6};
+        const double b_0{u_k(0) + model_params_.d_2 * sin(x_k(1)) * x_k(4) * x_k(4) + model_params_.d_3 * sin(x_k(2)) * x_k(5) * x_k(5)};
+        const double b_1{-model_params_.d_5 * sin(x_k(1) - x_k(2)) * x_k(5) * x_k(5) + model_params_.f_1 * sin(x_k(1))};
+        const double b_2{model_params_.d_5 * sin(x_k(1) - x_k(2)) * x_k(4) * x_k(4) + model_params_.f_2 * sin(x_k(2))};
+
+        // Solve D*x2_dot = b with the adjugate of D (Cramer's rule)
+        const double a_00{d_11 * d_22 - d_12 * d_12};
+        const double a_01{d_02 * d_12 - d_01 * d_22};
+        const double a_02{d_01 * d_12 - d_02 * d_11};
+        const double a_11{d_00 * d_22 - d_02 * d_02};
+        const double a_12{d_01 * d_02 - d_00 * d_12};
+        const double a_22{d_00 * d_11 - d_01 * d_01};
+        const double det{d_00 * a_00 + d_01 * a_01 + d_02 * a_02};
+
+        NativeVector<N> dx_(6, 1);
+        dx_(0) = x_k(3);
+        dx_(1) = x_k(4);
+        dx_(2) = x_k(5);
+        dx_(3) = (a_00 * b_0 + a_01 * b_1 + a_02 * b_2) / det;
+        dx_(4) = (a_01 * b_0 + a_11 * b_1 + a_12 * b_2) / det;
+        dx_(5) = (a_02 * b_0 + a_12 * b_1 + a_22 * b_2) / det;
+        return dx_;
     }
 
     template class ModelDIPC<DM>;
     template class ModelDIPC<MX>;
+    template class ModelDIPC<NativeVector<6>>;
 
 } // namespace nmpc
@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "Config.h"
+#include "MovingHorizonEstimator.h"
+#include "RuntimeParameters.h"
+
+using casadi::DM;
+using casadi::MX;
+using casadi::Slice;
+using std::string;
+using std::vector;
+
+namespace nmpc
+{
+
+    MovingHorizonEstimator::MovingHorizonEstimator(const std::string &config_file, const ModelBase<MX> &model, const Integrator<MX> &integrator)
+        : model_{model}, integrator_{integrator}
+    {
+        ReadParams(config_file);
+        BuildMHE();
+        Reset(mhe_params_.x_0);
+    }
+
+    void MovingHorizonEstimator::BuildMHE()
+    {
+        const int nx{mhe_params_.nx};
+        const int N{mhe_params_.n_window};
+        const int ny{static_cast<int>(mhe_params_.y_index.size())};
+        const DM &sc_x{mhe_params_.sc_x};
+        // Discretized system dynamics of one sample for the scaled states and the controls of the plant
+        const MX x = MX::sym("x", nx);
+        const MX u = MX::sym("u", mhe_params_.nu);
+        const MX theta = RuntimeParameterSymbols(model_);
+        const MX x_next = sc_x * integrator_(model_, mhe_params_.dt, x / sc_x, u);
+        F_ = casadi::Function("F", {x, u, theta}, {x_next}, {"x", "u", "theta"}, {"x_next"});
+        // Values of the runtime parameters of the model from the model file
+        vector<double> theta_0;
+        for (const RuntimeParameter<MX> &param : model_.runtime_parameters())
+        {
+            theta_0.push_back(param.value);
+        }
+        theta_val_ = DM(theta_0);
+
+        casadi::Opti nlp;
+        // Estimated states of the window (scaled) and process noise of the intervals (NLP variables)
+        const MX X = nlp.variable(nx, N + 1);
+        const MX W = nlp.variable(nx, N);
+        // Measurements of the nodes 1, ..., n_window and controls of the window, prior of the arrival cost, measurement weights of the nodes
+        // (0 for nodes without measurement while the window fills), node of the arrival cost and runtime parameters of the model (NLP parameters)
+        const MX Y = nlp.parameter(ny, N);
+        const MX U = nlp.parameter(mhe_params_.nu, N);
+        const MX x_bar = nlp.parameter(nx, 1);
+        const MX v = nlp.parameter(1, N);
+        const MX a = nlp.parameter(1, N + 1);
+        const int n_theta{static_cast<int>(theta.size1())};
+        const MX theta_p = n_theta > 0 ? nlp.parameter(n_theta, 1) : MX(0, 1);
+        // Process noise enters the dynamics additively (in the units of the states)
+        Slice all;
+        const MX X_next = F_.map(N)(vector<MX>{X(all, Slice(0, N)), U, theta_p})[0];
+        nlp.subject_to(X(all, Slice(1, N + 1)) == X_next + repmat(sc_x, 1, N) * W);
+        // Cost functional: arrival cost, measurement residuals and process noise
+        MX J = 0;
+        for (int k = 0; k <= N; k++)
+        {
+            const MX dx = X(all, k) / sc_x - x_bar;
+            J = J + a(k) * mtimes(dx.T(), mhe_params_.p_0 * dx);
+            if (k > 0)
+            {
+                const MX dy = X(mhe_params_.y_index, k) / sc_x(mhe_params_.y_index) - Y(all, k - 1);
+                J = J + v(k - 1) * mtimes(dy.T(), mhe_params_.q_y * dy) + mtimes(W(all, k - 1).T(), mhe_params_.q_w * W(all, k - 1));
+            }
+            // State constraints of the estimates
+            if (!mhe_params_.x_const_index.empty())
+            {
+                nlp.subject_to(sc_x(mhe_params_.x_const_index) * mhe_params_.x_const["min"] <= X(mhe_params_.x_const_index, k) <= sc_x(mhe_params_.x_const_index) * mhe_params_.x_const["max"]);
+            }
+        }
+        nlp.minimize(J);
+
+        // The Opti stack is only used to formulate the NLP, it is solved by one persistent solver function
+        // Decision variables x = [vec(X); vec(W)], parameters p = [vec(Y); vec(U); x_bar; v; a; theta]
+        casadi::Dict solver_opts;
+        if (mhe_params_.solver == "ipopt")
+        {
+            solver_opts["max_iter"] = mhe_params_.max_iter;
+            // IPOPT stops at the time budget (since IPOPT 3.14) and returns its last iterate
+            if (mhe_params_.budget > 0)
+            {
+                solver_opts["max_wall_time"] = mhe_params_.budget;
+            }
+        }
+        casadi::Dict opts;
+        opts[mhe_params_.solver] = solver_opts;
+        opts["error_on_fail"] = false;
+        const casadi::Function mhe("mhe", {MX::veccat({X, W}), MX::veccat({Y, U, x_bar, v, a, theta_p})}, {J, nlp.g()}, {"x", "p"}, {"f", "g"});
+        solver_ = casadi::nlpsol("solver", mhe_params_.solver, mhe, opts);
+        lbg_ = MX::evalf(nlp.lbg());
+        ubg_ = MX::evalf(nlp.ubg());
+    }
+
+    void MovingHorizonEstimator::Reset(const DM &x_0)
+    {
+        const int N{mhe_params_.n_window};
+        if (x_0.numel() != mhe_params_.nx)
+        {
+            throw std::runtime_error("The initial guess of the MHE needs " + std::to_string(mhe_params_.nx) + " states");
+        }
+        Y_ = DM::zeros(ny(), N);
+        U_ = DM::zeros(mhe_params_.nu, N);
+        n_meas_ = 0;
+        x_bar_ = vec(x_0);
+        X_sol_ = repmat(mhe_params_.sc_x * x_bar_, 1, N + 1);
+        W_sol_ = DM::zeros(mhe_params_.nx, N);
+        stats_ = EstimatorStats{0, "", false};
+    }
+
+    DM MovingHorizonEstimator::Update(const DM &y, const DM &u)
+    {
+        const int N{mhe_params_.n_window};
+        if (y.numel() != ny() || u.numel() != mhe_params_.nu)
+        {
+            throw std::runtime_error("The MHE needs " + std::to_string(ny()) + " measured outputs (mhe.y_index) and " + std::to_string(mhe_params_.nu) + " controls");
+        }
+        Slice all;
+        // Shift the window by one sample, before the first measurement the control is assumed to be held
+        Y_ = DM::horzcat({Y_(all, Slice(1, N)), vec(y)});
+        U_ = n_meas_ == 0 ? repmat(vec(u), 1, N) : DM::horzcat({U_(all, Slice(1, N)), vec(u)});
+        // Once the window is full, the estimate of the node which becomes the first node is the prior of the arrival cost
+        // (until then, the prior of the reset is the arrival cost of the node of the reset)
+        if (n_meas_ == N)
+        {
+            x_bar_ = X_sol_(all, 1) / mhe_params_.sc_x;
+        }
+        n_meas_ = std::min(n_meas_ + 1, N);
+        // Warm start: shift the previous solution and predict the new node with the model
+        const DM x_next = F_(vector<DM>{X_sol_(all, N), vec(u), theta_val_})[0];
+        X_sol_ = DM::horzcat({X_sol_(all, Slice(1, N + 1)), x_next});
+        W_sol_ = DM::horzcat({W_sol_(all, Slice(1, N)), DM::zeros(mhe_params_.nx, 1)});
+
+        casadi::DMDict sol;
+        try
+        {
+            sol = solver_(casadi::DMDict{{"x0", DM::veccat({X_sol_, W_sol_})}, {"p", Parameters()}, {"lbg", lbg_}, {"ubg", ubg_}});
+        }
+        catch (const std::exception &e)
+        {
+            // A solver error keeps the predicted estimate
+            stats_ = EstimatorStats{-1, e.what(), false};
+            return x_hat();
+        }
+        const casadi::Dict stats = solver_.stats();
+        stats_.iter_count = stats.count("iter_count") ? static_cast<int>(stats.at("iter_count").as_int()) : -1;
+        stats_.return_status = stats.count("return_status") ? stats.at("return_status").to_string() : "";
+        stats_.success = stats.count("success") && stats.at("success").as_bool();
+        const DM &g = sol.at("g");
+        const double constr_viol{static_cast<double>(norm_inf(fmax(fmax(lbg_ - g, g - ubg_), 0)))};
+        // Without convergence, the last iterate is only used if it is feasible, otherwise the predicted estimate is kept
+        if (stats_.success || constr_viol <= mhe_params_.feas_tol)
+        {
+            const DM w = sol.at("x");
+            const int n_X{mhe_params_.nx * (N + 1)};
+            X_sol_ = reshape(w(Slice(0, n_X)), mhe_params_.nx, N + 1);
+            W_sol_ = reshape(w(Slice(n_X, w.numel())), mhe_params_.nx, N);
+        }
+        return x_hat();
+    }
+
+    void MovingHorizonEstimator::SetModelParameters(const DM &theta)
+    {
+        const int n_theta{static_cast<int>(model_.runtime_parameters().size())};
+        if (theta.numel() != n_theta)
+        {
+            throw std::runtime_error("The model has " + std::to_string(n_theta) + " runtime parameters (model.runtime_parameters)");
+        }
+        theta_val_ = vec(theta);
+    }
+
+    DM MovingHorizonEstimator::Parameters() const
+    {
+        // Measured nodes are the last n_meas nodes of the window, the arrival cost is at the node before them
+        const int N{mhe_params_.n_window};
+        const int k_0{N - n_meas_};
+        DM v = DM::zeros(1, N);
+        DM a = DM::zeros(1, N + 1);
+        for (int k = k_0; k < N; k++)
+        {
+            v(k) = 1;
+        }
+        a(k_0) = 1;
+        return DM::veccat({Y_, U_, x_bar_, v, a, theta_val_});
+    }
+
+    void MovingHorizonEstimator::ReadParams(const std::string &config_file)
+    {
+        const YAML::Node config = LoadConfig(config_file);
+        mhe_params_.nx = config["nmpc.nx"].as<int>();
+        mhe_params_.nu = config["nmpc.nu"].as<int>();
+        mhe_params_.n_window = config["mhe.n_window"].as<int>(10);
+        // The measurements are sampled with the sampling time of the controller (first step size of a non-uniform grid)
+        const YAML::Node dt = config["ocp.dt"];
+        mhe_params_.dt = config["mhe.dt"].as<double>(dt.IsSequence() ? dt[0].as<double>() : dt.as<double>());
+        mhe_params_.solver = config["mhe.solver"].as<string>("ipopt");
+        mhe_params_.budget = config["mhe.budget.time"].as<double>(0);
+        mhe_params_.feas_tol = config["mhe.budget.feas_tol"].as<double>(1e-6);
+        mhe_params_.max_iter = config["mhe.max_iter"].as<int>(100);
+        mhe_params_.y_index = config["mhe.y_index"].as<vector<int>>();
+        mhe_params_.q_y = DM(config["mhe.q_y"].as<vector<double>>());
+        mhe_params_.q_w = DM(config["mhe.q_w"].as<vector<double>>());
+        mhe_params_.p_0 = DM(config["mhe.p_0"].as<vector<double>>());
+        mhe_params_.x_0 = DM(config["mhe.x_0"].as<vector<double>>(config["nmpc.x_0"].as<vector<double>>()));
+        mhe_params_.sc_x = config["ocp.scale.x"].as<vector<double>>();
+        mhe_params_.x_const["min"] = config["mhe.con.x_min"].as<vector<double>>(vector<double>());
+        mhe_params_.x_const["max"] = config["mhe.con.x_max"].as<vector<double>>(vector<double>());
+        mhe_params_.x_const_index = config["mhe.con.x_index"].as<vector<int>>(vector<int>());
+        if (mhe_params_.n_window < 1 || mhe_params_.q_y.numel() != static_cast<casadi::casadi_int>(mhe_params_.y_index.size()) ||
+            mhe_params_.q_w.numel() != mhe_params_.nx || mhe_params_.p_0.numel() != mhe_params_.nx)
+        {
+            throw std::runtime_error("The MHE needs mhe.n_window >= 1, a weight mhe.q_y for each measured state (mhe.y_index) and "
+                                     "the weights mhe.q_w and mhe.p_0 for all states");
+        }
+    }
+
+} // namespace nmpc
@@ -1,6 +1,9 @@
+#include <algorithm>
+#include <chrono>
 #include <math.h>
+#include <time.h>
 #include <vector>
-#include <yaml-cpp/yaml.h>
+#include "Config.h"
 #include "NonlinearModelPredictiveControl.h"
 
 using casadi::DM;
@@ -11,18 +14,147 @@ using std::vector;
 namespace nmpc
 {
 
-    NonlinearModelPredictiveControl::NonlinearModelPredictiveControl(const std::string &config_file, const ModelBase<MX> &model, const Integrator<casadi::MX> &integrator) : ocp_{config_file, model, integrator}
+    namespace
+    {
+        // Wall time in seconds
+        double WallTime()
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        // CPU time of the calling thread in seconds
+        double CPUTime()
+        {
+            timespec t;
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+            return t.tv_sec + 1e-9 * t.tv_nsec;
+        }
+    } // namespace
+
+    NonlinearModelPredictiveControl::NonlinearModelPredictiveControl(const std::string &config_file, const ModelBase<MX> &model, const Integrator<casadi::MX> &integrator)
+        : ocp_{config_file, model, integrator}, telemetry_{config_file}
     {
         ReadParams(config_file);
+        x_meas_ = nmpc_params_.x_0;
+        if (nmpc_params_.mode == "explicit")
+        {
+            policy_ = ExplicitPolicy::Load(ReadExplicitPolicyParams(config_file), ocp_.ModelHash());
+        }
+    }
+
+    void NonlinearModelPredictiveControl::SetReference(const DM &x_ref)
+    {
+        ocp_.SetReference(x_ref);
+        nmpc_params_.x_e = x_ref(Slice(), x_ref.size2() - 1);
+        policy_ = ExplicitPolicy();
+    }
+
+    void NonlinearModelPredictiveControl::SetWeights(const DM &q, const DM &r, const DM &p)
+    {
+        ocp_.SetWeights(q, r, p);
+        policy_ = ExplicitPolicy();
+    }
+
+    void NonlinearModelPredictiveControl::SetModelParameters(const DM &theta)
+    {
+        ocp_.SetModelParameters(theta);
+        policy_ = ExplicitPolicy();
+    }
+
+    DM NonlinearModelPredictiveControl::ComputeControlInput()
+    {
+        Slice all;
+        SampleTelemetry sample{};
+        sample.t_init_wall = t_init_wall_;
+        sample.t_init_cpu = t_init_cpu_;
+
+        // Solve phase: interpolation of the explicit policy, the OCP is only solved outside of its coverage or if its quality check fails
+        const double t_solve_wall{WallTime()};
+        const double t_solve_cpu{CPUTime()};
+        std::vector<double> u_policy;
+        const bool use_policy{nmpc_params_.mode == "explicit" && policy_.Evaluate(static_cast<std::vector<double>>(x_meas_), u_policy)};
+        DM U;
+        double t_deferred_wall{0};
+        double t_deferred_cpu{0};
+        if (!use_policy)
+        {
+            // In the explicit mode, the OCP is only initialized in the samples, in which it is solved. If the policy answered since the
+            // last solution, the previous solution is outdated and the OCP is cold started instead of warm started
+            if (ocp_init_pending_)
+            {
+                const double t_init_wall{WallTime()};
+                const double t_init_cpu{CPUTime()};
+                policy_answered_ ? ocp_.Reset(x_meas_) : ocp_.Init(x_meas_);
+                ocp_init_pending_ = false;
+                policy_answered_ = false;
+                t_deferred_wall = WallTime() - t_init_wall;
+                t_deferred_cpu = CPUTime() - t_init_cpu;
+            }
+            U = nmpc_params_.mode == "rti" ? ocp_.FeedbackRTI() : ocp_.Solve();
+        }
+        policy_answered_ = policy_answered_ || use_policy;
+        sample.t_solve_wall = WallTime() - t_solve_wall - t_deferred_wall;
+        sample.t_solve_cpu = CPUTime() - t_solve_cpu - t_deferred_cpu;
+        sample.t_init_wall += t_deferred_wall;
+        sample.t_init_cpu += t_deferred_cpu;
+
+        // Extraction phase
+        const double t_extract_wall{WallTime()};
+        const double t_extract_cpu{CPUTime()};
+        u_k_ = use_policy ? DM(u_policy) : DM(U(all, 0));
+        sample.t_extract_wall = WallTime() - t_extract_wall;
+        sample.t_extract_cpu = CPUTime() - t_extract_cpu;
+
+        const SolverStats stats{use_policy ? SolverStats{0, "Explicit_Policy", true, 0, ControlSource::Solution} : ocp_.stats()};
+        sample.iter_count = stats.iter_count;
+        sample.success = stats.success;
+        sample.constr_viol = stats.constr_viol;
+        const std::size_t n_status{std::min(stats.return_status.size(), sample.return_status.size() - 1)};
+        std::copy_n(stats.return_status.begin(), n_status, sample.return_status.begin());
+        sample.return_status[n_status] = '\0';
+        telemetry_.Record(sample);
+
+        // The preparation phase of the real-time iteration is attributed to the initialization of the next sample
+        t_init_wall_ = 0;
+        t_init_cpu_ = 0;
+        if (nmpc_params_.mode == "rti")
+        {
+            const double t_prepare_wall{WallTime()};
+            const double t_prepare_cpu{CPUTime()};
+            ocp_.PrepareRTI();
+            t_init_wall_ += WallTime() - t_prepare_wall;
+            t_init_cpu_ += CPUTime() - t_prepare_cpu;
+        }
+
+        return u_k_;
+    }
+
+    void NonlinearModelPredictiveControl::SetInitialCondition(const DM &x_meas)
+    {
+        const double t_init_wall{WallTime()};
+        const double t_init_cpu{CPUTime()};
+        x_meas_ = x_meas;
+        if (nmpc_params_.mode == "explicit")
+        {
+            ocp_init_pending_ = true;
+        }
+        else
+        {
+            ocp_.Init(x_meas);
+        }
+        t_init_wall_ += WallTime() - t_init_wall;
+        t_init_cpu_ += CPUTime() - t_init_cpu;
     }
 
     void NonlinearModelPredictiveControl::ReadParams(const std::string &config_file)
     {
-        YAML::Node config = YAML::LoadFile(config_file);
+        const YAML::Node config = LoadConfig(config_file);
         nmpc_params_.x_0 = config["nmpc.x_0"].as<std::vector<double>>();
         nmpc_params_.x_e = config["nmpc.x_e"].as<std::vector<double>>();
+        nmpc_params_.x_e_index = config["nmpc.x_e_index"].as<std::vector<int>>();
         nmpc_params_.nx = config["nmpc.nx"].as<int>();
         nmpc_params_.nu = config["nmpc.nu"].as<int>();
+        nmpc_params_.mode = config["nmpc.mode"].as<std::string>("nlp");
     }
 
 } // namespace nmpc
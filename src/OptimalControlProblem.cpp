@@ -1,18 +1,56 @@
+#include <algorithm>
 #include <assert.h>
+#include <chrono>
+#include <cmath>
 #include <math.h>
-#include <yaml-cpp/yaml.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include "Collocation.h"
+#include "Config.h"
+#include "MoveBlocking.h"
 #include "OptimalControlProblem.h"
+#include "RuntimeParameters.h"
+#include "ShootingGrid.h"
+#include "TimeScaledModel.h"
 
 using casadi::DM;
 using casadi::MX;
-using casadi::OptiSol;
 using casadi::Slice;
 using std::string;
 using std::vector;
 
+// Compiler command for the generated code, set by the build system
+#ifndef NMPC_CODEGEN_COMPILER
+#define NMPC_CODEGEN_COMPILER "gcc"
+#endif
+#ifndef NMPC_CODEGEN_FLAGS
+#define NMPC_CODEGEN_FLAGS "-O3 -march=native -fPIC -shared"
+#endif
+
 namespace nmpc
 {
 
+    namespace
+    {
+        // Single-quoted shell word of a path (quotes in the path are closed, escaped and reopened)
+        string ShellQuote(const string &path)
+        {
+            string quoted{"'"};
+            for (char c : path)
+            {
+                quoted += c == '\'' ? string("'\\''") : string(1, c);
+            }
+            return quoted + "'";
+        }
+    } // namespace
+
     OptimalControlProblem::OptimalControlProblem(const std::string &config_file, const ModelBase<MX> &model, const Integrator<casadi::MX> &integrator) : model_{model}, integrator_{integrator}
     {
         ReadParams(config_file);
@@ -22,63 +60,901 @@ namespace nmpc
 
     void OptimalControlProblem::BuildOCP()
     {
+        const bool collocation{ocp_params_.transcription == "collocation"};
+        if (collocation && (ocp_params_.mode == "rti" || ocp_params_.solver == "riccati"))
+        {
+            throw std::runtime_error("The collocation transcription needs the nlp mode with an NLP solver of casadi");
+        }
+        BuildBlocking();
+        const int n_blocks{static_cast<int>(block_start_.size())};
+        if (n_blocks < ocp_params_.n_shoot && (ocp_params_.mode == "rti" || ocp_params_.solver == "riccati"))
+        {
+            throw std::runtime_error("Move blocking needs the nlp mode with an NLP solver of casadi");
+        }
+        BuildGrid();
+        // Discretized system dynamics of one shooting interval of length h (built once and mapped over all shooting intervals)
+        const MX x = MX::sym("x", ocp_params_.nx);
+        const MX u = MX::sym("u", ocp_params_.nu);
+        const MX h = MX::sym("h");
+        const MX theta = RuntimeParameterSymbols(model_);
+        const TimeScaledModel scaled_model{model_, h};
+        const MX x_next = ocp_params_.sc_x * integrator_(scaled_model, 1.0, x / ocp_params_.sc_x, u / ocp_params_.sc_u);
+        F_ = casadi::Function("F", {x, u, h, theta}, {x_next}, {"x", "u", "h", "theta"}, {"x_next"});
+        F_jac_ = casadi::Function("F_jac", {x, u, h, theta}, {jacobian(x_next, x), jacobian(x_next, u)}, {"x", "u", "h", "theta"}, {"A", "B"});
+        // Values of the runtime parameters of the model from the model file
+        std::vector<double> theta_0;
+        for (const RuntimeParameter<MX> &param : model_.runtime_parameters())
+        {
+            theta_0.push_back(param.value);
+        }
+        theta_val_ = DM(theta_0);
+        // The persistent NLP solver is loaded from the cache if the config, the model and the integrator are unchanged
+        const bool cached{ocp_params_.cache && ocp_params_.mode == "nlp" && ocp_params_.solver != "riccati"};
+        const string cache_file{cached ? CacheFile() : ""};
+        if (cached && LoadCache(cache_file))
+        {
+            SetReference(ocp_params_.x_e);
+            SetWeights(ocp_params_.Q, ocp_params_.R, ocp_params_.P);
+            Reset(ocp_params_.x_0);
+            return;
+        }
         nlp_ = casadi::Opti();
-        // Initial guess
-        X_sol_ = repmat(ocp_params_.sc_x * ocp_params_.x_0, 1, ocp_params_.n_shoot + 1);
-        U_sol_ = repmat(0.5 * ocp_params_.sc_u * (ocp_params_.u_const["max"] - ocp_params_.u_const["min"]), 1, ocp_params_.n_shoot);
         // Initial condition
         X_0_ = nlp_.parameter(ocp_params_.nx, 1);
+        // References of the shooting nodes 1, ..., n_shoot and diagonals of the weighting matrices (NLP parameters, updated without rebuild)
+        const int n_e{static_cast<int>(ocp_params_.x_e_index.size())};
+        X_ref_ = nlp_.parameter(n_e, ocp_params_.n_shoot);
+        q_ = nlp_.parameter(n_e, 1);
+        r_ = nlp_.parameter(ocp_params_.nu, 1);
+        p_ = nlp_.parameter(n_e, 1);
+        // Runtime parameters of the model (NLP parameters, updated without rebuild)
+        const int n_theta{static_cast<int>(theta.size1())};
+        theta_ = n_theta > 0 ? nlp_.parameter(n_theta, 1) : MX(0, 1);
+        P_nlp_ = MX::veccat({X_0_, X_ref_, q_, r_, p_, theta_});
         // Discretized state and control trajectory (NLP parameters)
         X_ = nlp_.variable(ocp_params_.nx, ocp_params_.n_shoot + 1);
-        U_ = nlp_.variable(ocp_params_.nu, ocp_params_.n_shoot);
+        // With move blocking, only the controls of the blocks are NLP parameters and each is held over the intervals of its block
+        Uc_ = nlp_.variable(ocp_params_.nu, n_blocks);
+        U_ = n_blocks < ocp_params_.n_shoot ? mtimes(Uc_, T_block_) : Uc_;
+        // States at the collocation points of all intervals (NLP parameters, only for the collocation transcription)
+        Xc_ = collocation ? nlp_.variable(ocp_params_.nx, ocp_params_.degree * ocp_params_.n_shoot) : MX(ocp_params_.nx, 0);
+        const casadi::Function F_map = Map(F_);
         // Cost functional
         J_ = 0;
         Slice all;
         MX X_next;
-        for (int i = 0; i < ocp_params_.n_shoot; i++)
+        MX coll_eq;
+        if (collocation)
+        {
+            const std::vector<MX> coll = Map(BuildCollocation())(std::vector<MX>{X_(all, Slice(0, ocp_params_.n_shoot)), Xc_, U_, MX(H_), theta_});
+            coll_eq = coll[0];
+            X_next = coll[1];
+        }
+        else
+        {
+            X_next = F_map(std::vector<MX>{X_(all, Slice(0, ocp_params_.n_shoot)), U_, MX(H_), theta_})[0];
+        }
+        nlp_.subject_to(X_(all, Slice(1, ocp_params_.n_shoot + 1)) == X_next);
+        for (int i = 0, b = 0; i < ocp_params_.n_shoot; i++)
         {
-            X_next = ocp_params_.sc_x * integrator_(model_, ocp_params_.dt, X_(all, i) / ocp_params_.sc_x, U_(all, i) / ocp_params_.sc_u);
-            nlp_.subject_to(X_(all, i + 1) == X_next);
-            // Set input constraints
-            nlp_.subject_to(ocp_params_.sc_u(ocp_params_.u_const_index) * ocp_params_.u_const["min"] <= U_((ocp_params_.u_const_index), i) <= ocp_params_.sc_u(ocp_params_.u_const_index) * ocp_params_.u_const["max"]);
+            // Set input constraints (once per block)
+            if (b < n_blocks && block_start_[b] == i)
+            {
+                nlp_.subject_to(ocp_params_.sc_u(ocp_params_.u_const_index) * ocp_params_.u_const["min"] <= Uc_((ocp_params_.u_const_index), b) <= ocp_params_.sc_u(ocp_params_.u_const_index) * ocp_params_.u_const["max"]);
+                b++;
+            }
             // Set path constraints
             nlp_.subject_to(ocp_params_.sc_x(ocp_params_.x_const_index) * ocp_params_.x_const["min"] <= X_(ocp_params_.x_const_index, i + 1) <= ocp_params_.sc_x(ocp_params_.x_const_index) * ocp_params_.x_const["max"]);
-            // Cost functional (setpoint stabilization)
-            const MX &dx = X_(ocp_params_.x_e_index, i + 1) - ocp_params_.x_e;
+            // Cost functional (setpoint stabilization), the stage costs are weighted with the interval length relative to the first interval
+            const MX &dx = X_(ocp_params_.x_e_index, i + 1) - X_ref_(all, i);
             const MX &du = U_(all, i);
-            J_ = J_ + mtimes(dx.T(), mtimes(ocp_params_.Q, dx));
-            J_ = J_ + mtimes(du.T(), mtimes(ocp_params_.R, du));
+            const MX stage_cost = mtimes(dx.T(), q_ * dx) + mtimes(du.T(), r_ * du);
+            const double w_i{ocp_params_.dt_interval[i] / ocp_params_.dt};
+            J_ = J_ + (w_i == 1 ? stage_cost : w_i * stage_cost);
         }
         // Set terminal cost
-        J_ = J_ + mtimes((X_(ocp_params_.x_e_index, ocp_params_.n_shoot) - ocp_params_.x_e).T(), mtimes(ocp_params_.P, X_(ocp_params_.x_e_index, ocp_params_.n_shoot) - ocp_params_.x_e));
+        const MX dx_N = X_(ocp_params_.x_e_index, ocp_params_.n_shoot) - X_ref_(all, ocp_params_.n_shoot - 1);
+        J_ = J_ + mtimes(dx_N.T(), p_ * dx_N);
         // Terminal condition
         // nlp_.subject_to(X_(all,ocp_params_.n_shoot) == ocp_params_.sc_x*ocp_params_.x_e);
         // Set initial condition
         nlp_.subject_to(X_(all, 0) == X_0_);
-        nlp_.set_value(X_0_, ocp_params_.sc_x * ocp_params_.x_0);
-        // Set initial guess
-        nlp_.set_initial(X_, X_sol_);
-        nlp_.set_initial(U_, U_sol_);
-        // Set solver
-        nlp_.solver(ocp_params_.solver);
+        // Collocation equations
+        if (collocation)
+        {
+            nlp_.subject_to(coll_eq == 0);
+        }
         // Set objective
         nlp_.minimize(J_);
+        // Set up the Riccati SQP, the persistent NLP solver or the real-time iteration scheme
+        if (ocp_params_.solver == "riccati")
+        {
+            BuildRiccati(X_next);
+        }
+        else if (ocp_params_.mode == "rti")
+        {
+            BuildRTI(X_next);
+        }
+        else
+        {
+            BuildSolver();
+            if (cached)
+            {
+                SaveCache(cache_file);
+            }
+        }
+        SetReference(ocp_params_.x_e);
+        SetWeights(ocp_params_.Q, ocp_params_.R, ocp_params_.P);
+        Reset(ocp_params_.x_0);
+    }
+
+    std::string OptimalControlProblem::CacheFile() const
+    {
+        // The cache file is identified by a hash of the config file, the serialized dynamics of one shooting interval
+        // (model parameters, integrator and scaling factors) and the casadi version
+        const string key{std::to_string(ocp_params_.config_hash) + F_.serialize() + casadi::CasadiMeta::version()};
+        return ocp_params_.cache_dir + "/nmpc_ocp_" + std::to_string(std::hash<string>{}(key)) + ".casadi";
+    }
+
+    std::size_t OptimalControlProblem::ModelHash() const
+    {
+        std::ostringstream key;
+        key.precision(17);
+        key << F_.serialize();
+        for (double theta : static_cast<vector<double>>(theta_val_))
+        {
+            key << ' ' << theta;
+        }
+        return std::hash<string>{}(key.str());
+    }
+
+    bool OptimalControlProblem::LoadCache(const std::string &cache_file)
+    {
+        if (!std::ifstream(cache_file).good())
+        {
+            return false;
+        }
+        try
+        {
+            casadi::FileDeserializer cache(cache_file);
+            solver_ = cache.unpack_function();
+            lbg_ = cache.unpack_dm();
+            ubg_ = cache.unpack_dm();
+            Xc_ = MX(ocp_params_.nx, static_cast<int>(cache.unpack_int()));
+        }
+        catch (const std::exception &)
+        {
+            // Incomplete or incompatible cache file (e.g. a deleted shared library of the generated code): rebuild the OCP
+            return false;
+        }
+        return true;
+    }
+
+    void OptimalControlProblem::SaveCache(const std::string &cache_file) const
+    {
+        // The file is written under a temporary name and renamed, so a concurrently starting process never reads a partial file
+        mkdir(ocp_params_.cache_dir.c_str(), 0755);
+        const string tmp_file{cache_file + "." + std::to_string(getpid()) + ".tmp"};
+        {
+            casadi::FileSerializer cache(tmp_file);
+            cache.pack(solver_.function());
+            cache.pack(lbg_);
+            cache.pack(ubg_);
+            cache.pack(static_cast<casadi::casadi_int>(Xc_.size2()));
+        }
+        std::rename(tmp_file.c_str(), cache_file.c_str());
+    }
+
+    void OptimalControlProblem::BuildSolver()
+    {
+        // Reinjected multipliers are only used by IPOPT with its warm start options
+        casadi::Dict solver_opts;
+        if (ocp_params_.solver == "ipopt" && ocp_params_.warm_start_multipliers)
+        {
+            solver_opts["warm_start_init_point"] = "yes";
+            solver_opts["warm_start_bound_push"] = 1e-9;
+            solver_opts["warm_start_bound_frac"] = 1e-9;
+            solver_opts["warm_start_slack_bound_push"] = 1e-9;
+            solver_opts["warm_start_slack_bound_frac"] = 1e-9;
+            solver_opts["warm_start_mult_bound_push"] = 1e-9;
+            solver_opts["mu_init"] = ocp_params_.mu_init;
+        }
+        // IPOPT stops at the time budget (since IPOPT 3.14) and returns its last iterate
+        if (ocp_params_.solver == "ipopt" && ocp_params_.budget > 0)
+        {
+            solver_opts["max_wall_time"] = ocp_params_.budget;
+        }
+        if (ocp_params_.hessian != "exact" && ocp_params_.solver != "ipopt")
+        {
+            throw std::runtime_error("The Hessian approximations (ocp.hessian) need the NLP solver ipopt");
+        }
+        if (ocp_params_.hessian == "limited_memory")
+        {
+            solver_opts["hessian_approximation"] = "limited-memory";
+        }
+        casadi::Dict opts;
+        opts[ocp_params_.solver] = solver_opts;
+        if (ocp_params_.hessian == "gauss_newton")
+        {
+            // The cost functional is a sum of squares of residuals which are linear in the decision variables, so its hessian is the
+            // Gauss-Newton hessian 2*J_r'*W*J_r (constant for given weights). The curvature of the constraints (second derivatives of the
+            // dynamics) is neglected
+            const MX w = MX::veccat({X_, Uc_, Xc_});
+            const MX lam_f = MX::sym("lam_f");
+            const MX lam_g = MX::sym("lam_g", nlp_.g().size1());
+            opts["hess_lag"] = casadi::Function("nlp_hess_l", {w, P_nlp_, lam_f, lam_g}, {triu(lam_f * hessian(J_, w), true)}, {"x", "p", "lam_f", "lam_g"}, {"hess_gamma_x_x"});
+        }
+        // Failed solves are handled by Solve (feasible iterate or fallback)
+        opts["error_on_fail"] = false;
+        // The Opti stack is only used to formulate the NLP, it is solved by one persistent solver function
+        // Decision variables x = [vec(X); vec(U) (controls of the blocks); vec(Xc)], parameters p = [X_0; vec(X_ref); q; r; p]
+        const casadi::Function nlp("nlp", {MX::veccat({X_, Uc_, Xc_}), P_nlp_}, {J_, nlp_.g()}, {"x", "p"}, {"f", "g"});
+        if (ocp_params_.codegen)
+        {
+            // Load the NLP functions (objective, constraints and their derivatives) from the compiled shared library
+            solver_ = casadi::nlpsol("solver", ocp_params_.solver, Compile(nlp, opts), opts);
+        }
+        else
+        {
+            solver_ = casadi::nlpsol("solver", ocp_params_.solver, nlp, opts);
+        }
+        lbg_ = MX::evalf(nlp_.lbg());
+        ubg_ = MX::evalf(nlp_.ubg());
+    }
+
+    DM OptimalControlProblem::Solve()
+    {
+        if (ocp_params_.solver == "riccati")
+        {
+            // Gauss-Newton SQP with the Riccati QP solver until the step is below the tolerance or the time budget is used up
+            // The last iterate with feasible shooting gaps is kept (the interior point QP solver keeps the bounds satisfied)
+            const auto t_start = std::chrono::steady_clock::now();
+            bool expired{false};
+            bool failed{false};
+            DM X_feas;
+            DM U_feas;
+            stats_.success = false;
+            stats_.iter_count = 0;
+            while (stats_.iter_count < ocp_params_.sqp_max_iter && !stats_.success && !expired)
+            {
+                stats_.iter_count++;
+                LinearizeRiccati();
+                if (stats_.constr_viol <= ocp_params_.feas_tol)
+                {
+                    X_feas = X_sol_;
+                    U_feas = U_sol_;
+                }
+                const double step{StepRiccati()};
+                if (!std::isfinite(step))
+                {
+                    failed = true;
+                    break;
+                }
+                stats_.success = step < ocp_params_.sqp_tol;
+                expired = ocp_params_.budget > 0 && std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count() > ocp_params_.budget;
+            }
+            stats_.return_status = stats_.success ? "Solve_Succeeded" : failed ? "Step_Failed" : expired ? "Maximum_WallTime_Exceeded" : "Maximum_Iterations_Exceeded";
+            if (stats_.success)
+            {
+                Accept(ControlSource::Solution);
+            }
+            else if (!U_feas.is_empty())
+            {
+                X_sol_ = X_feas;
+                U_sol_ = U_feas;
+                Accept(ControlSource::FeasibleIterate);
+            }
+            else
+            {
+                return Fallback();
+            }
+            return U_sol_ / ocp_params_.sc_u;
+        }
+        const bool warm_start_multipliers{ocp_params_.warm_start_multipliers};
+        casadi::DMDict sol;
+        try
+        {
+            sol = solver_(casadi::DMDict{{"x0", DM::veccat({X_sol_, U_sol_(Slice(), block_start_), Xc_sol_})},
+                                         {"p", Parameters()},
+                                         {"lbg", lbg_},
+                                         {"ubg", ubg_},
+                                         {"lam_x0", warm_start_multipliers ? lam_x_ : DM()},
+                                         {"lam_g0", warm_start_multipliers ? lam_g_ : DM()}});
+        }
+        catch (const std::exception &e)
+        {
+            // A solver error must not leave the controller without a control
+            stats_ = SolverStats{-1, e.what(), false, INFINITY, ControlSource::Fallback};
+            return Fallback();
+        }
+        const casadi::Dict stats = solver_.stats();
+        stats_.iter_count = stats.count("iter_count") ? static_cast<int>(stats.at("iter_count").as_int()) : -1;
+        stats_.return_status = stats.count("return_status") ? stats.at("return_status").to_string() : "";
+        stats_.success = stats.count("success") && stats.at("success").as_bool();
+        const DM &g = sol.at("g");
+        stats_.constr_viol = static_cast<double>(norm_inf(fmax(fmax(lbg_ - g, g - ubg_), 0)));
+        // Without convergence (time budget, iteration limit or failure), the last iterate is only used if it is feasible
+        if (!stats_.success && !(stats_.constr_viol <= ocp_params_.feas_tol))
+        {
+            return Fallback();
+        }
+        SetSolution(Unblock(sol.at("x")));
+        lam_x_ = sol.at("lam_x");
+        lam_g_ = sol.at("lam_g");
+        Accept(stats_.success ? ControlSource::Solution : ControlSource::FeasibleIterate);
+        return U_sol_ / ocp_params_.sc_u;
+    }
+
+    void OptimalControlProblem::Accept(ControlSource source)
+    {
+        X_acc_ = X_sol_;
+        U_acc_ = U_sol_;
+        stats_.source = source;
+    }
+
+    DM OptimalControlProblem::Fallback()
+    {
+        // The control of the previous plan for the current sample comes first, the last control is held
+        Slice all;
+        const int n_shoot{ocp_params_.n_shoot};
+        Shift(X_acc_, U_acc_, X_acc_(all, n_shoot), U_acc_(all, n_shoot - 1));
+        X_sol_ = X_acc_;
+        U_sol_ = U_acc_;
+        stats_.source = ControlSource::Fallback;
+        return U_sol_ / ocp_params_.sc_u;
+    }
+
+    void OptimalControlProblem::BuildGrid()
+    {
+        H_ = DM(ocp_params_.dt_interval).T();
+        shift_pos_ = ShiftPositions(ocp_params_.dt_interval);
+    }
+
+    void OptimalControlProblem::Shift(DM &X, DM &U, const DM &x_next, const DM &u_N) const
+    {
+        ShiftTrajectories(shift_pos_, X, U, x_next, u_N);
+    }
+
+    void OptimalControlProblem::BuildBlocking()
+    {
+        block_start_ = BlockStarts(ocp_params_.n_shoot, ocp_params_.control_horizon, ocp_params_.move_blocking);
+        T_block_ = BlockingMatrix(block_start_, ocp_params_.n_shoot);
+    }
+
+    DM OptimalControlProblem::Unblock(const DM &w) const
+    {
+        return UnblockControls(w, ocp_params_.nx * (ocp_params_.n_shoot + 1), ocp_params_.nu, T_block_);
+    }
+
+    casadi::Function OptimalControlProblem::BuildCollocation() const
+    {
+        // Collocation points tau_1, ..., tau_d in (0, 1] and tau_0 = 0 for the state at the beginning of the interval
+        const int d{ocp_params_.degree};
+        std::vector<double> tau{0};
+        const std::vector<double> tau_c = casadi::collocation_points(d, ocp_params_.scheme);
+        tau.insert(tau.end(), tau_c.begin(), tau_c.end());
+        // Lagrange polynomials l_j of the points: C(j, r) = dl_j/dtau(tau_r) and D(j) = l_j(1)
+        std::vector<double> C_jr;
+        std::vector<double> D_j;
+        CollocationCoefficients(tau, C_jr, D_j);
+        const DM C = reshape(DM(C_jr), d + 1, d + 1);
+        const DM D = DM(D_j);
+        // Collocation equations of one interval of length h for the scaled states: h*f(x_r, u) = sum_j C(j, r)*x_j at the collocation points
+        // Models in descriptor form are collocated implicitly without a linear solve: M(x_r)*sum_j C(j, r)*x_j/sc_x = h*f(x_r, u)
+        const MX x = MX::sym("x", ocp_params_.nx);
+        const MX xc = MX::sym("xc", ocp_params_.nx, d);
+        const MX u = MX::sym("u", ocp_params_.nu);
+        const MX h = MX::sym("h");
+        const MX theta = RuntimeParameterSymbols(model_);
+        const MX x_all = MX::horzcat({x, xc});
+        std::vector<MX> eq;
+        for (int r = 1; r <= d; r++)
+        {
+            const MX x_r = xc(Slice(), r - 1);
+            if (model_.descriptor_form())
+            {
+                const MX M_r = model_.MassMatrix(x_r / ocp_params_.sc_x);
+                const MX f_r = model_.RightHandSide(x_r / ocp_params_.sc_x, u / ocp_params_.sc_u);
+                eq.push_back(h * f_r - mtimes(M_r, mtimes(x_all, C(Slice(), r)) / ocp_params_.sc_x));
+            }
+            else
+            {
+                const MX f_r = ocp_params_.sc_x * model_(x_r / ocp_params_.sc_x, u / ocp_params_.sc_u);
+                eq.push_back(h * f_r - mtimes(x_all, C(Slice(), r)));
+            }
+        }
+        return casadi::Function("G", {x, xc, u, h, theta}, {MX::veccat(eq), mtimes(x_all, D)}, {"x", "xc", "u", "h", "theta"}, {"eq", "x_next"});
+    }
+
+    casadi::Function OptimalControlProblem::Map(const casadi::Function &f) const
+    {
+        return ocp_params_.parallelization == "thread" ? f.map(ocp_params_.n_shoot, ocp_params_.parallelization, ocp_params_.n_threads)
+                                                       : f.map(ocp_params_.n_shoot, ocp_params_.parallelization);
+    }
+
+    void OptimalControlProblem::BuildBounds()
+    {
+        const int n_x{ocp_params_.nx * (ocp_params_.n_shoot + 1)};
+        const int n_w{n_x + ocp_params_.nu * ocp_params_.n_shoot};
+        lbw_ = -DM::inf(n_w);
+        ubw_ = DM::inf(n_w);
+        for (int i = 0; i < ocp_params_.n_shoot; i++)
+        {
+            for (int c = 0; c < static_cast<int>(ocp_params_.x_const_index.size()); c++)
+            {
+                const int j{ocp_params_.x_const_index[c]};
+                lbw_((i + 1) * ocp_params_.nx + j) = ocp_params_.sc_x(j) * ocp_params_.x_const["min"](c);
+                ubw_((i + 1) * ocp_params_.nx + j) = ocp_params_.sc_x(j) * ocp_params_.x_const["max"](c);
+            }
+            for (int c = 0; c < static_cast<int>(ocp_params_.u_const_index.size()); c++)
+            {
+                const int j{ocp_params_.u_const_index[c]};
+                lbw_(n_x + i * ocp_params_.nu + j) = ocp_params_.sc_u(j) * ocp_params_.u_const["min"](c);
+                ubw_(n_x + i * ocp_params_.nu + j) = ocp_params_.sc_u(j) * ocp_params_.u_const["max"](c);
+            }
+        }
+    }
+
+    void OptimalControlProblem::BuildRTI(const MX &X_next)
+    {
+        Slice all;
+        // Stacked decision variables w = [vec(X); vec(U)] and shooting gaps as equality constraints
+        const MX w = MX::veccat({X_, U_});
+        const MX g = vec(X_(all, Slice(1, ocp_params_.n_shoot + 1)) - X_next);
+        // The cost functional is a sum of quadratic terms, its hessian is the Gauss-Newton hessian of the OCP
+        MX grad_J;
+        const MX H = hessian(J_, w, grad_J);
+        rti_lin_ = casadi::Function("rti_lin", {w, P_nlp_}, {g, jacobian(g, w), grad_J, H}, {"w", "p"}, {"g", "jac_g", "grad_J", "H"});
+        if (ocp_params_.codegen)
+        {
+            rti_lin_ = casadi::external("rti_lin", Compile(rti_lin_));
+        }
+        rti_qp_ = casadi::conic("rti_qp", ocp_params_.qp_solver, {{"h", rti_lin_.sparsity_out(3)}, {"a", rti_lin_.sparsity_out(1)}});
+        // Simple bounds on the decision variables
+        BuildBounds();
+    }
+
+    void OptimalControlProblem::BuildRiccati(const MX &X_next)
+    {
+        const int nx{ocp_params_.nx};
+        const int nu{ocp_params_.nu};
+        const int n_shoot{ocp_params_.n_shoot};
+        Slice all;
+        // Shooting gaps, stage-wise jacobians of the dynamics and gradient of the cost functional
+        const MX w = MX::veccat({X_, U_});
+        const std::vector<MX> AB = Map(F_jac_)(std::vector<MX>{X_(all, Slice(0, n_shoot)), U_, MX(H_), theta_});
+        MX grad_J;
+        const MX H = hessian(J_, w, grad_J);
+        ric_lin_ = casadi::Function("ric_lin", {w, P_nlp_}, {X_next - X_(all, Slice(1, n_shoot + 1)), AB[0], AB[1], grad_J}, {"w", "p"}, {"c", "A", "B", "grad_J"});
+        if (ocp_params_.codegen)
+        {
+            ric_lin_ = casadi::external("ric_lin", Compile(ric_lin_));
+        }
+        // The cost functional is a sum of quadratic stage terms, so its hessian is block diagonal and only depends on the weights
+        ric_hess_ = casadi::Function("ric_hess", {w, P_nlp_}, {H}, {"w", "p"}, {"H"});
+        ric_stages_.assign(n_shoot + 1, RiccatiStage());
+        riccati_ = RiccatiSolver(nx, nu, n_shoot, RiccatiParams{ocp_params_.riccati_max_iter, ocp_params_.riccati_tol});
+        BuildBounds();
+    }
+
+    void OptimalControlProblem::UpdateRiccatiHessian()
+    {
+        const int nx{ocp_params_.nx};
+        const int nu{ocp_params_.nu};
+        const int n_shoot{ocp_params_.n_shoot};
+        const int n_x{nx * (n_shoot + 1)};
+        const int n_w{n_x + nu * n_shoot};
+        // The hessian does not depend on the decision variables and the initial state
+        const DM p = DM::veccat({DM::zeros(nx), X_ref_val_, q_val_, r_val_, p_val_, theta_val_});
+        const DM H_w = ric_hess_(std::vector<DM>{DM::zeros(n_w), p})[0];
+        for (int k = 0; k <= n_shoot; k++)
+        {
+            const Slice x_k(k * nx, (k + 1) * nx);
+            ric_stages_[k].Q = std::vector<double>(densify(H_w(x_k, x_k)));
+            if (k < n_shoot)
+            {
+                const Slice u_k(n_x + k * nu, n_x + (k + 1) * nu);
+                ric_stages_[k].S = std::vector<double>(densify(H_w(u_k, x_k)));
+                // Small regularization for controls without weight and bounds
+                ric_stages_[k].R = std::vector<double>(densify(H_w(u_k, u_k) + 1e-9 * DM::eye(nu)));
+            }
+        }
+    }
+
+    void OptimalControlProblem::LinearizeRiccati()
+    {
+        const int nx{ocp_params_.nx};
+        const int nu{ocp_params_.nu};
+        const int n_x{nx * (ocp_params_.n_shoot + 1)};
+        const std::vector<DM> lin = ric_lin_(std::vector<DM>{DM::veccat({X_sol_, U_sol_}), Parameters()});
+        const std::vector<double> c(densify(lin[0]));
+        const std::vector<double> A(densify(lin[1]));
+        const std::vector<double> B(densify(lin[2]));
+        const std::vector<double> grad_J(densify(lin[3]));
+        // Constraint violation of the iterate: shooting gaps and initial condition (the shifted warm start begins at the previous
+        // prediction of the state, not at the measurement)
+        const std::vector<double> dx_0(densify(X_sol_(Slice(), 0) - x_meas_));
+        stats_.constr_viol = 0;
+        for (const double c_i : c)
+        {
+            stats_.constr_viol = fmax(stats_.constr_viol, fabs(c_i));
+        }
+        for (const double dx_0i : dx_0)
+        {
+            stats_.constr_viol = fmax(stats_.constr_viol, fabs(dx_0i));
+        }
+        for (int k = 0; k <= ocp_params_.n_shoot; k++)
+        {
+            RiccatiStage &stage{ric_stages_[k]};
+            stage.q.assign(&grad_J[k * nx], &grad_J[(k + 1) * nx]);
+            if (k < ocp_params_.n_shoot)
+            {
+                stage.r.assign(&grad_J[n_x + k * nu], &grad_J[n_x + (k + 1) * nu]);
+                stage.A.assign(&A[k * nx * nx], &A[(k + 1) * nx * nx]);
+                stage.B.assign(&B[k * nx * nu], &B[(k + 1) * nx * nu]);
+                stage.c.assign(&c[k * nx], &c[(k + 1) * nx]);
+            }
+        }
+    }
+
+    double OptimalControlProblem::StepRiccati()
+    {
+        // QP for the step dw with the initial state fixed to the measurement
+        const DM w = DM::veccat({X_sol_, U_sol_});
+        const std::vector<double> lbw(lbw_ - w);
+        const std::vector<double> ubw(ubw_ - w);
+        std::vector<double> dw(w.size1(), 0.0);
+        for (int i = 0; i < ocp_params_.nx; i++)
+        {
+            dw[i] = static_cast<double>(x_meas_(i) - w(i));
+        }
+        if (!riccati_.Solve(ric_stages_, lbw, ubw, dw))
+        {
+            // Failed factorization or no convergence of the QP: no step is applied
+            return INFINITY;
+        }
+        // Full Gauss-Newton step
+        SetSolution(w + DM(dw));
+        double step{0};
+        for (const double dw_i : dw)
+        {
+            step = fmax(step, fabs(dw_i));
+        }
+        return step;
+    }
+
+    void OptimalControlProblem::Reset(const DM &x_0)
+    {
+        // Initial guess
+        X_sol_ = repmat(ocp_params_.sc_x * x_0, 1, ocp_params_.n_shoot + 1);
+        U_sol_ = repmat(0.5 * ocp_params_.sc_u * (ocp_params_.u_const["max"] - ocp_params_.u_const["min"]), 1, ocp_params_.n_shoot);
+        Xc_sol_ = repmat(ocp_params_.sc_x * x_0, 1, Xc_.size2());
+        X_acc_ = X_sol_;
+        U_acc_ = U_sol_;
+        lam_x_ = DM();
+        lam_g_ = DM();
+        x_meas_ = ocp_params_.sc_x * x_0;
+        if (ocp_params_.mode == "rti")
+        {
+            // Converge the first linearization point with full SQP iterations for the initial state
+            LinearizeRTI();
+            for (int k = 0; k < ocp_params_.n_init_iter; k++)
+            {
+                FeedbackRTI();
+                if (stats_.source == ControlSource::Fallback)
+                {
+                    break;
+                }
+                LinearizeRTI();
+            }
+        }
+    }
+
+    void OptimalControlProblem::SetReference(const DM &x_ref)
+    {
+        const int n_e{static_cast<int>(ocp_params_.x_e_index.size())};
+        const int n_shoot{ocp_params_.n_shoot};
+        if (x_ref.size1() != n_e || (x_ref.size2() != 1 && x_ref.size2() != n_shoot))
+        {
+            throw std::runtime_error("The reference needs " + std::to_string(n_e) + " rows (nmpc.x_e_index) and 1 or " + std::to_string(n_shoot) + " columns");
+        }
+        const DM sc_e = ocp_params_.sc_x(ocp_params_.x_e_index);
+        X_ref_val_ = x_ref.size2() == 1 ? repmat(sc_e * x_ref, 1, n_shoot) : repmat(sc_e, 1, n_shoot) * x_ref;
+    }
+
+    void OptimalControlProblem::SetWeights(const DM &q, const DM &r, const DM &p)
+    {
+        const int n_e{static_cast<int>(ocp_params_.x_e_index.size())};
+        if (q.numel() != n_e || r.numel() != ocp_params_.nu || p.numel() != n_e)
+        {
+            throw std::runtime_error("The weights need " + std::to_string(n_e) + " (q, p) and " + std::to_string(ocp_params_.nu) + " (r) diagonal entries");
+        }
+        q_val_ = vec(q);
+        r_val_ = vec(r);
+        p_val_ = vec(p);
+        // Numerical weighting matrices (embedded in the full state vector) for the terminal LQR, whose gain is recomputed on its next use
+        DM S = DM::zeros(n_e, ocp_params_.nx);
+        for (int c = 0; c < n_e; c++)
+        {
+            S(c, ocp_params_.x_e_index[c]) = 1;
+        }
+        Q_lqr_ = mtimes(S.T(), mtimes(diag(q_val_), S));
+        R_lqr_ = diag(r_val_) + 1e-9 * DM::eye(ocp_params_.nu);
+        P_lqr_ = mtimes(S.T(), mtimes(diag(p_val_), S));
+        K_lqr_ = DM();
+        if (ocp_params_.solver == "riccati")
+        {
+            UpdateRiccatiHessian();
+        }
+    }
+
+    void OptimalControlProblem::SetModelParameters(const DM &theta)
+    {
+        const int n_theta{static_cast<int>(model_.runtime_parameters().size())};
+        if (theta.numel() != n_theta)
+        {
+            throw std::runtime_error("The model has " + std::to_string(n_theta) + " runtime parameters (model.runtime_parameters)");
+        }
+        theta_val_ = vec(theta);
+        // The terminal LQR gain depends on the linearized model and is recomputed on its next use
+        K_lqr_ = DM();
+    }
+
+    DM OptimalControlProblem::Parameters() const
+    {
+        return DM::veccat({x_meas_, X_ref_val_, q_val_, r_val_, p_val_, theta_val_});
+    }
+
+    void OptimalControlProblem::Init(const DM &x_0)
+    {
+        x_meas_ = ocp_params_.sc_x * x_0;
+        // The real-time iteration shifts its linearization point in the preparation phase
+        if (ocp_params_.mode != "rti")
+        {
+            WarmStart(ocp_params_.warm_start);
+        }
+    }
+
+    void OptimalControlProblem::PrepareRTI()
+    {
+        // The single SQP step of the next sample starts from the previous solution, which must refer to the next sample time
+        WarmStart(ocp_params_.warm_start == "none" ? "shift_hold" : ocp_params_.warm_start);
+        LinearizeRTI();
+    }
+
+    void OptimalControlProblem::WarmStart(const std::string &strategy)
+    {
+        if (strategy == "none")
+        {
+            return;
+        }
+        // Shift the previous solution one shooting interval forward in time and extend it at the end of the horizon
+        Slice all;
+        const int n_shoot{ocp_params_.n_shoot};
+        const DM x_N = X_sol_(all, n_shoot);
+        DM u_N = U_sol_(all, n_shoot - 1);
+        DM x_next = x_N;
+        if (strategy == "shift_lqr")
+        {
+            u_N = TerminalControl(x_N, u_N);
+        }
+        if (strategy == "shift_lqr" || strategy == "shift_rollout")
+        {
+            x_next = F_(std::vector<DM>{x_N, u_N, DM(ocp_params_.dt_interval.back()), theta_val_})[0];
+        }
+        Shift(X_sol_, U_sol_, x_next, u_N);
+        // The collocation states of the last interval are initialized with the extended state
+        // (on a non-uniform grid, the collocation states of each interval are initialized with the shifted state at its beginning)
+        const int d{static_cast<int>(Xc_sol_.size2()) / n_shoot};
+        if (d > 0 && shift_pos_.empty())
+        {
+            Xc_sol_ = DM::horzcat({Xc_sol_(all, Slice(d, d * n_shoot)), repmat(x_next, 1, d)});
+        }
+        else if (d > 0)
+        {
+            std::vector<DM> Xc;
+            for (int k = 0; k < n_shoot; k++)
+            {
+                Xc.push_back(repmat(X_sol_(all, k), 1, d));
+            }
+            Xc_sol_ = DM::horzcat(Xc);
+        }
+        // Shift the multipliers stage-wise with the same layout as the constraints in BuildOCP (with move blocking, the input constraints
+        // are not stage-wise and the multipliers are reinjected without shift)
+        const int n_stage{static_cast<int>(ocp_params_.u_const_index.size() + ocp_params_.x_const_index.size())};
+        ShiftMultipliers(lam_g_, ocp_params_.nx, n_shoot, n_stage, ocp_params_.nx * d);
+    }
+
+    DM OptimalControlProblem::TerminalControl(const DM &x_N, const DM &u_N)
+    {
+        if (K_lqr_.is_empty())
+        {
+            // Discrete time LQR gain for the dynamics linearized at the end of the first solution
+            const std::vector<DM> AB = F_jac_(std::vector<DM>{x_N, u_N, DM(ocp_params_.dt_interval.back()), theta_val_});
+            const DM &A = AB[0];
+            const DM &B = AB[1];
+            const DM &Q = Q_lqr_;
+            const DM &R = R_lqr_;
+            // Solve the discrete algebraic riccati equation by fixed point iteration, starting from the terminal weight
+            DM P = Q + P_lqr_;
+            for (int k = 0; k < 200; k++)
+            {
+                const DM BP = mtimes(B.T(), P);
+                P = Q + mtimes(A.T(), mtimes(P, A)) - mtimes(mtimes(BP, A).T(), solve(R + mtimes(BP, B), mtimes(BP, A)));
+            }
+            const DM BP = mtimes(B.T(), P);
+            K_lqr_ = solve(R + mtimes(BP, B), mtimes(BP, A));
+        }
+        // Feedback on the deviation of the terminal state from the required terminal state
+        DM x_ref = x_N;
+        x_ref(ocp_params_.x_e_index) = X_ref_val_(Slice(), ocp_params_.n_shoot - 1);
+        DM u = u_N - mtimes(K_lqr_, x_N - x_ref);
+        for (int c = 0; c < static_cast<int>(ocp_params_.u_const_index.size()); c++)
+        {
+            const int j{ocp_params_.u_const_index[c]};
+            u(j) = fmin(fmax(u(j), ocp_params_.sc_u(j) * ocp_params_.u_const["min"](c)), ocp_params_.sc_u(j) * ocp_params_.u_const["max"](c));
+        }
+        return u;
+    }
+
+    DM OptimalControlProblem::FeedbackRTI()
+    {
+        if (ocp_params_.solver == "riccati")
+        {
+            stats_.iter_count = 1;
+            stats_.success = std::isfinite(StepRiccati());
+            if (!stats_.success)
+            {
+                stats_.return_status = "Step_Failed";
+                return Fallback();
+            }
+            stats_.return_status = "Solve_Succeeded";
+            Accept(ControlSource::Solution);
+            return U_sol_ / ocp_params_.sc_u;
+        }
+        // Fix the initial state to the measurement via the bounds of the prepared QP
+        const DM w = DM::veccat({X_sol_, U_sol_});
+        DM lbw = lbw_ - w;
+        DM ubw = ubw_ - w;
+        const Slice x_0(0, ocp_params_.nx);
+        lbw(x_0) = x_meas_ - w(x_0);
+        ubw(x_0) = x_meas_ - w(x_0);
+        const casadi::DMDict qp_sol = rti_qp_(casadi::DMDict{{"h", rti_H_}, {"g", rti_grad_J_}, {"a", rti_jac_g_}, {"lba", -rti_g_}, {"uba", -rti_g_}, {"lbx", lbw}, {"ubx", ubw}});
+        // Full Gauss-Newton step
+        SetSolution(w + qp_sol.at("x"));
+        const casadi::Dict stats = rti_qp_.stats();
+        stats_.iter_count = 1;
+        stats_.return_status = stats.count("return_status") ? stats.at("return_status").to_string() : "";
+        stats_.success = stats.count("success") && stats.at("success").as_bool();
+        stats_.constr_viol = static_cast<double>(norm_inf(rti_g_));
+        Accept(ControlSource::Solution);
+        return U_sol_ / ocp_params_.sc_u;
+    }
+
+    void OptimalControlProblem::SetSolution(const DM &w)
+    {
+        const int n_x{ocp_params_.nx * (ocp_params_.n_shoot + 1)};
+        const int n_u{ocp_params_.nu * ocp_params_.n_shoot};
+        X_sol_ = reshape(w(Slice(0, n_x)), ocp_params_.nx, ocp_params_.n_shoot + 1);
+        U_sol_ = reshape(w(Slice(n_x, n_x + n_u)), ocp_params_.nu, ocp_params_.n_shoot);
+        if (w.size1() > n_x + n_u)
+        {
+            Xc_sol_ = reshape(w(Slice(n_x + n_u, w.size1())), ocp_params_.nx, w.size1() - n_x - n_u);
+        }
+    }
+
+    void OptimalControlProblem::LinearizeRTI()
+    {
+        if (ocp_params_.solver == "riccati")
+        {
+            LinearizeRiccati();
+            return;
+        }
+        const std::vector<DM> lin = rti_lin_(std::vector<DM>{DM::veccat({X_sol_, U_sol_}), Parameters()});
+        rti_g_ = lin[0];
+        rti_jac_g_ = lin[1];
+        rti_grad_J_ = lin[2];
+        rti_H_ = lin[3];
+    }
+
+    std::string OptimalControlProblem::Compile(const casadi::Function &f, const casadi::Dict &solver_opts) const
+    {
+        // The shared library is identified by a hash of the serialized function, the solver and the compiler command,
+        // so it is reused across runs as long as the config, the model and the integrator are unchanged
+        const bool is_nlp{f.name() == "nlp"};
+        const string compile_cmd{ocp_params_.compiler + " " + ocp_params_.compiler_flags};
+        const string key{f.serialize() + compile_cmd + (is_nlp ? ocp_params_.solver + casadi::str(solver_opts) : "")};
+        const string lib_name{"nmpc_" + f.name() + "_" + std::to_string(std::hash<string>{}(key))};
+        const string lib_file{ocp_params_.codegen_dir + "/" + lib_name + ".so"};
+        if (std::ifstream(lib_file).good())
+        {
+            return lib_file;
+        }
+        // Generate the C code (for the NLP, the code of all functions the solver depends on) in the codegen directory and build the shared library
+        // The files of this process have unique names and the library is renamed when it is complete, so concurrently starting processes
+        // neither overwrite each other's sources nor load a partially written library
+        mkdir(ocp_params_.codegen_dir.c_str(), 0755);
+        const string tmp_name{lib_name + "_" + std::to_string(getpid())};
+        const string c_file{ocp_params_.codegen_dir + "/" + tmp_name + ".c"};
+        const string tmp_file{lib_file + "." + std::to_string(getpid()) + ".tmp"};
+        casadi::CodeGenerator gen(tmp_name);
+        gen.add(f);
+        if (is_nlp)
+        {
+            const casadi::Function solver{casadi::nlpsol("solver", ocp_params_.solver, f, solver_opts)};
+            for (const string &name : solver.get_function())
+            {
+                gen.add(solver.get_function(name));
+            }
+        }
+        gen.generate(ocp_params_.codegen_dir + "/");
+        const int status{std::system((compile_cmd + " " + ShellQuote(c_file) + " -o " + ShellQuote(tmp_file)).c_str())};
+        std::remove(c_file.c_str());
+        if (status == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || std::rename(tmp_file.c_str(), lib_file.c_str()) != 0)
+        {
+            std::remove(tmp_file.c_str());
+            throw std::runtime_error("Compilation of the generated code failed: " + lib_file);
+        }
+        return lib_file;
     }
 
     void OptimalControlProblem::ReadParams(const std::string &config_file)
     {
-        YAML::Node config = YAML::LoadFile(config_file);
+        const YAML::Node config = LoadConfig(config_file);
         ocp_params_.nx = config["nmpc.nx"].as<int>();
         ocp_params_.nu = config["nmpc.nu"].as<int>();
         ocp_params_.n_shoot = config["ocp.n_shoot"].as<int>();
-        ocp_params_.dt = config["ocp.dt"].as<double>();
+        // Step sizes of the shooting intervals: one step size for all intervals (optionally growing geometrically) or one per interval
+        const YAML::Node dt = config["ocp.dt"];
+        if (dt.IsSequence())
+        {
+            ocp_params_.dt_interval = dt.as<vector<double>>();
+        }
+        else
+        {
+            ocp_params_.dt_interval = GrowingStepSizes(dt.as<double>(), config["ocp.dt_growth"].as<double>(1.0), ocp_params_.n_shoot);
+        }
+        if (static_cast<int>(ocp_params_.dt_interval.size()) != ocp_params_.n_shoot)
+        {
+            throw std::runtime_error("ocp.dt needs one step size or one step size for each of the ocp.n_shoot intervals");
+        }
+        ocp_params_.dt = ocp_params_.dt_interval[0];
         ocp_params_.solver = config["ocp.solver"].as<string>();
+        ocp_params_.mode = config["nmpc.mode"].as<string>("nlp");
+        ocp_params_.qp_solver = config["ocp.rti.qp_solver"].as<string>("qrqp");
+        ocp_params_.n_init_iter = config["ocp.rti.n_init_iter"].as<int>(0);
+        ocp_params_.hessian = config["ocp.hessian"].as<string>("exact");
+        ocp_params_.warm_start = config["ocp.warm_start.strategy"].as<string>("none");
+        ocp_params_.warm_start_multipliers = config["ocp.warm_start.multipliers"].as<bool>(false);
+        ocp_params_.mu_init = config["ocp.warm_start.mu_init"].as<double>(1e-4);
+        ocp_params_.codegen = config["ocp.codegen.enable"].as<bool>(false);
+        ocp_params_.codegen_dir = config["ocp.codegen.dir"].as<string>("codegen");
+        ocp_params_.compiler = config["ocp.codegen.compiler"].as<string>(NMPC_CODEGEN_COMPILER);
+        ocp_params_.compiler_flags = config["ocp.codegen.flags"].as<string>(NMPC_CODEGEN_FLAGS);
+        ocp_params_.cache = config["ocp.cache.enable"].as<bool>(false);
+        ocp_params_.cache_dir = config["ocp.cache.dir"].as<string>("cache");
+        ocp_params_.config_hash = ConfigHash(config_file);
+        ocp_params_.parallelization = config["ocp.map.parallelization"].as<string>("serial");
+        ocp_params_.n_threads = config["ocp.map.n_threads"].as<int>(1);
+        ocp_params_.control_horizon = config["ocp.control_horizon"].as<int>(ocp_params_.n_shoot);
+        // The move blocking pattern is a list of block lengths or a single block length for all blocks
+        const YAML::Node move_blocking = config["ocp.move_blocking"];
+        ocp_params_.move_blocking = !move_blocking ? vector<int>() : move_blocking.IsSequence() ? move_blocking.as<vector<int>>() : vector<int>{move_blocking.as<int>()};
+        ocp_params_.transcription = config["ocp.transcription"].as<string>("multiple_shooting");
+        ocp_params_.degree = config["ocp.collocation.degree"].as<int>(3);
+        ocp_params_.scheme = config["ocp.collocation.scheme"].as<string>("radau");
+        ocp_params_.budget = config["ocp.budget.time"].as<double>(0);
+        ocp_params_.feas_tol = config["ocp.budget.feas_tol"].as<double>(1e-6);
+        ocp_params_.sqp_max_iter = config["ocp.sqp.max_iter"].as<int>(20);
+        ocp_params_.sqp_tol = config["ocp.sqp.tol"].as<double>(1e-6);
+        ocp_params_.riccati_max_iter = config["ocp.riccati.max_iter"].as<int>(50);
+        ocp_params_.riccati_tol = config["ocp.riccati.tol"].as<double>(1e-8);
         ocp_params_.x_0 = config["nmpc.x_0"].as<vector<double>>();
-        ocp_params_.x_e = config["nmpc.x_e"].as<vector<double>>();
+        ocp_params_.x_e = DM(config["nmpc.x_e"].as<vector<double>>());
         ocp_params_.x_e_index = config["nmpc.x_e_index"].as<vector<int>>();
-        ocp_params_.R = MX::eye(ocp_params_.nu) * config["ocp.r"].as<vector<double>>();
-        ocp_params_.Q = MX::eye(ocp_params_.x_e_index.size()) * config["ocp.q"].as<vector<double>>();
-        ocp_params_.P = MX::eye(ocp_params_.x_e_index.size()) * config["ocp.p"].as<vector<double>>();
+        ocp_params_.R = DM(config["ocp.r"].as<vector<double>>());
+        ocp_params_.Q = DM(config["ocp.q"].as<vector<double>>());
+        ocp_params_.P = DM(config["ocp.p"].as<vector<double>>());
         ocp_params_.x_const["min"] = config["ocp.con.x_min"].as<vector<double>>();
         ocp_params_.x_const["max"] = config["ocp.con.x_max"].as<vector<double>>();
         ocp_params_.x_const_index = config["ocp.con.x_index"].as<vector<int>>();
@@ -0,0 +1,392 @@
+#include <algorithm>
+#include <cmath>
+#include "RiccatiSolver.h"
+
+namespace nmpc
+{
+
+    namespace
+    {
+        // C = op(A)*op(B) + beta*C for dense column-major matrices, op(A) is m x k, op(B) is k x n
+        void MatMul(int m, int n, int k, const double *A, bool trans_A, const double *B, bool trans_B, double beta, double *C)
+        {
+            for (int j = 0; j < n; j++)
+            {
+                for (int i = 0; i < m; i++)
+                {
+                    double sum{0};
+                    for (int l = 0; l < k; l++)
+                    {
+                        sum += (trans_A ? A[l + i * k] : A[i + l * m]) * (trans_B ? B[j + l * n] : B[l + j * k]);
+                    }
+                    C[i + j * m] = sum + beta * C[i + j * m];
+                }
+            }
+        }
+
+        // Cholesky factorization A = L*L' of a symmetric positive definite n x n matrix, L is stored in the lower triangle
+        bool Cholesky(int n, std::vector<double> &A)
+        {
+            for (int j = 0; j < n; j++)
+            {
+                double d{A[j + j * n]};
+                for (int l = 0; l < j; l++)
+                {
+                    d -= A[j + l * n] * A[j + l * n];
+                }
+                if (!(d > 0))
+                {
+                    return false;
+                }
+                A[j + j * n] = std::sqrt(d);
+                for (int i = j + 1; i < n; i++)
+                {
+                    double s{A[i + j * n]};
+                    for (int l = 0; l < j; l++)
+                    {
+                        s -= A[i + l * n] * A[j + l * n];
+                    }
+                    A[i + j * n] = s / A[j + j * n];
+                }
+            }
+            return true;
+        }
+
+        // Solve L*L'*x = b in place with the cholesky factor L
+        void CholeskySolve(int n, const std::vector<double> &L, double *b)
+        {
+            for (int i = 0; i < n; i++)
+            {
+                for (int l = 0; l < i; l++)
+                {
+                    b[i] -= L[i + l * n] * b[l];
+                }
+                b[i] /= L[i + i * n];
+            }
+            for (int i = n - 1; i >= 0; i--)
+            {
+                for (int l = i + 1; l < n; l++)
+                {
+                    b[i] -= L[l + i * n] * b[l];
+                }
+                b[i] /= L[i + i * n];
+            }
+        }
+
+        // Largest step which keeps v + alpha*dv >= 0
+        double MaxStep(double v, double dv)
+        {
+            return dv < 0 ? -v / dv : INFINITY;
+        }
+    } // namespace
+
+    RiccatiSolver::RiccatiSolver(int nx, int nu, int n_stages, const RiccatiParams &params)
+        : nx_{nx}, nu_{nu}, n_stages_{n_stages}, n_x_{nx * (n_stages + 1)}, params_(params), iter_{0}, converged_{false}
+    {
+        const int n_w{n_x_ + nu * n_stages};
+        pi_.resize(nx * n_stages);
+        pi_new_.resize(nx * n_stages);
+        lam_l_.resize(n_w);
+        lam_u_.resize(n_w);
+        sigma_.resize(n_w);
+        dw_.resize(n_w);
+        P_.assign(n_stages + 1, std::vector<double>(nx * nx));
+        p_.assign(n_stages + 1, std::vector<double>(nx));
+        K_.assign(n_stages, std::vector<double>(nu * nx));
+        k_.assign(n_stages, std::vector<double>(nu));
+        L_.assign(n_stages, std::vector<double>(nu * nu));
+    }
+
+    bool RiccatiSolver::Solve(const std::vector<RiccatiStage> &stages, const std::vector<double> &lbw, const std::vector<double> &ubw, std::vector<double> &w)
+    {
+        const int nx{nx_};
+        const int nu{nu_};
+        const int N{n_stages_};
+        const int n_w{static_cast<int>(w.size())};
+        // Move the initial guess into the interior of the bounds (x_0 is fixed)
+        std::vector<bool> has_l(n_w, false);
+        std::vector<bool> has_u(n_w, false);
+        int n_bounds{0};
+        for (int j = nx; j < n_w; j++)
+        {
+            has_l[j] = std::isfinite(lbw[j]);
+            has_u[j] = std::isfinite(ubw[j]);
+            const double width{has_l[j] && has_u[j] ? ubw[j] - lbw[j] : INFINITY};
+            if (has_l[j])
+            {
+                w[j] = std::max(w[j], lbw[j] + std::min(1e-2 * std::max(1.0, std::fabs(lbw[j])), 1e-2 * width));
+            }
+            if (has_u[j])
+            {
+                w[j] = std::min(w[j], ubw[j] - std::min(1e-2 * std::max(1.0, std::fabs(ubw[j])), 1e-2 * width));
+            }
+            lam_l_[j] = has_l[j] ? 1.0 : 0.0;
+            lam_u_[j] = has_u[j] ? 1.0 : 0.0;
+            n_bounds += has_l[j] + has_u[j];
+        }
+        std::fill(pi_.begin(), pi_.end(), 0.0);
+        std::vector<double> grad(n_w);
+        std::vector<double> res(nx * N);
+        std::vector<double> g(n_w);
+        std::vector<double> dlam_l(n_w);
+        std::vector<double> dlam_u(n_w);
+        converged_ = false;
+        for (iter_ = 0; iter_ <= params_.max_iter; iter_++)
+        {
+            // Gradient of the cost and residuals of the dynamics
+            std::fill(grad.begin(), grad.end(), 0.0);
+            for (int k = 0; k <= N; k++)
+            {
+                const RiccatiStage &stage{stages[k]};
+                const double *x_k{&w[k * nx]};
+                MatMul(nx, 1, nx, stage.Q.data(), false, x_k, false, 0, &grad[k * nx]);
+                for (int i = 0; i < nx; i++)
+                {
+                    grad[k * nx + i] += stage.q[i];
+                }
+                if (k == N)
+                {
+                    break;
+                }
+                const double *u_k{&w[n_x_ + k * nu]};
+                MatMul(nx, 1, nu, stage.S.data(), true, u_k, false, 1, &grad[k * nx]);
+                MatMul(nu, 1, nu, stage.R.data(), false, u_k, false, 0, &grad[n_x_ + k * nu]);
+                MatMul(nu, 1, nx, stage.S.data(), false, x_k, false, 1, &grad[n_x_ + k * nu]);
+                for (int i = 0; i < nu; i++)
+                {
+                    grad[n_x_ + k * nu + i] += stage.r[i];
+                }
+                std::copy(stage.c.begin(), stage.c.end(), &res[k * nx]);
+                MatMul(nx, 1, nx, stage.A.data(), false, x_k, false, 1, &res[k * nx]);
+                MatMul(nx, 1, nu, stage.B.data(), false, u_k, false, 1, &res[k * nx]);
+                for (int i = 0; i < nx; i++)
+                {
+                    res[k * nx + i] -= w[(k + 1) * nx + i];
+                }
+            }
+            // KKT residuals: stationarity of the lagrangian, dynamics and complementarity
+            std::copy(grad.begin(), grad.end(), g.begin());
+            for (int k = 0; k < N; k++)
+            {
+                MatMul(nx, 1, nx, stages[k].A.data(), true, &pi_[k * nx], false, 1, &g[k * nx]);
+                MatMul(nu, 1, nx, stages[k].B.data(), true, &pi_[k * nx], false, 1, &g[n_x_ + k * nu]);
+                for (int i = 0; i < nx; i++)
+                {
+                    g[(k + 1) * nx + i] -= pi_[k * nx + i];
+                }
+            }
+            double kkt{0};
+            double mu{0};
+            for (int j = nx; j < n_w; j++)
+            {
+                kkt = std::max(kkt, std::fabs(g[j] - lam_l_[j] + lam_u_[j]));
+                mu += (has_l[j] ? (w[j] - lbw[j]) * lam_l_[j] : 0) + (has_u[j] ? (ubw[j] - w[j]) * lam_u_[j] : 0);
+            }
+            for (const double r : res)
+            {
+                kkt = std::max(kkt, std::fabs(r));
+            }
+            mu = n_bounds > 0 ? mu / n_bounds : 0;
+            if (kkt < params_.tol && mu < params_.tol)
+            {
+                converged_ = true;
+                break;
+            }
+            if (iter_ == params_.max_iter || !std::isfinite(kkt + mu))
+            {
+                break;
+            }
+            // Barrier hessian and factorization of the Newton system
+            for (int j = nx; j < n_w; j++)
+            {
+                sigma_[j] = (has_l[j] ? lam_l_[j] / (w[j] - lbw[j]) : 0) + (has_u[j] ? lam_u_[j] / (ubw[j] - w[j]) : 0);
+            }
+            if (!Factorize(stages))
+            {
+                break;
+            }
+            // Predictor: affine scaling step
+            SolveKKT(stages, grad, res);
+            double alpha{1};
+            for (int j = nx; j < n_w; j++)
+            {
+                if (has_l[j])
+                {
+                    dlam_l[j] = -lam_l_[j] - lam_l_[j] / (w[j] - lbw[j]) * dw_[j];
+                    alpha = std::min({alpha, MaxStep(w[j] - lbw[j], dw_[j]), MaxStep(lam_l_[j], dlam_l[j])});
+                }
+                if (has_u[j])
+                {
+                    dlam_u[j] = -lam_u_[j] + lam_u_[j] / (ubw[j] - w[j]) * dw_[j];
+                    alpha = std::min({alpha, MaxStep(ubw[j] - w[j], -dw_[j]), MaxStep(lam_u_[j], dlam_u[j])});
+                }
+            }
+            double mu_aff{0};
+            for (int j = nx; j < n_w; j++)
+            {
+                mu_aff += (has_l[j] ? (w[j] - lbw[j] + alpha * dw_[j]) * (lam_l_[j] + alpha * dlam_l[j]) : 0) +
+                          (has_u[j] ? (ubw[j] - w[j] - alpha * dw_[j]) * (lam_u_[j] + alpha * dlam_u[j]) : 0);
+            }
+            mu_aff = n_bounds > 0 ? mu_aff / n_bounds : 0;
+            const double sigma_mu{mu > 0 ? std::pow(mu_aff / mu, 3) * mu : 0};
+            // Corrector: centered step with the second order correction of the complementarity
+            std::copy(grad.begin(), grad.end(), g.begin());
+            for (int j = nx; j < n_w; j++)
+            {
+                if (has_l[j])
+                {
+                    dlam_l[j] = (sigma_mu - dw_[j] * dlam_l[j]) / (w[j] - lbw[j]);
+                    g[j] -= dlam_l[j];
+                }
+                if (has_u[j])
+                {
+                    dlam_u[j] = (sigma_mu + dw_[j] * dlam_u[j]) / (ubw[j] - w[j]);
+                    g[j] += dlam_u[j];
+                }
+            }
+            SolveKKT(stages, g, res);
+            alpha = INFINITY;
+            for (int j = nx; j < n_w; j++)
+            {
+                if (has_l[j])
+                {
+                    dlam_l[j] += -lam_l_[j] - lam_l_[j] / (w[j] - lbw[j]) * dw_[j];
+                    alpha = std::min({alpha, MaxStep(w[j] - lbw[j], dw_[j]), MaxStep(lam_l_[j], dlam_l[j])});
+                }
+                if (has_u[j])
+                {
+                    dlam_u[j] += -lam_u_[j] + lam_u_[j] / (ubw[j] - w[j]) * dw_[j];
+                    alpha = std::min({alpha, MaxStep(ubw[j] - w[j], -dw_[j]), MaxStep(lam_u_[j], dlam_u[j])});
+                }
+            }
+            // Fraction to the boundary
+            alpha = std::min(1.0, 0.995 * alpha);
+            for (int j = nx; j < n_w; j++)
+            {
+                w[j] += alpha * dw_[j];
+                lam_l_[j] += has_l[j] ? alpha * dlam_l[j] : 0;
+                lam_u_[j] += has_u[j] ? alpha * dlam_u[j] : 0;
+            }
+            for (int i = 0; i < nx * N; i++)
+            {
+                pi_[i] += alpha * (pi_new_[i] - pi_[i]);
+            }
+        }
+        return converged_;
+    }
+
+    bool RiccatiSolver::Factorize(const std::vector<RiccatiStage> &stages)
+    {
+        const int nx{nx_};
+        const int nu{nu_};
+        const int N{n_stages_};
+        std::vector<double> PA(nx * nx);
+        std::vector<double> PB(nx * nu);
+        std::vector<double> S_bar(nu * nx);
+        P_[N] = stages[N].Q;
+        for (int i = 0; i < nx; i++)
+        {
+            P_[N][i + i * nx] += sigma_[N * nx + i];
+        }
+        for (int k = N - 1; k >= 0; k--)
+        {
+            const RiccatiStage &stage{stages[k]};
+            MatMul(nx, nx, nx, P_[k + 1].data(), false, stage.A.data(), false, 0, PA.data());
+            MatMul(nx, nu, nx, P_[k + 1].data(), false, stage.B.data(), false, 0, PB.data());
+            // R_bar = R + B'*P*B, S_bar = S + B'*P*A
+            std::vector<double> &R_bar{L_[k]};
+            R_bar = stage.R;
+            MatMul(nu, nu, nx, stage.B.data(), true, PB.data(), false, 1, R_bar.data());
+            for (int i = 0; i < nu; i++)
+            {
+                R_bar[i + i * nu] += sigma_[n_x_ + k * nu + i];
+            }
+            S_bar = stage.S;
+            MatMul(nu, nx, nx, stage.B.data(), true, PA.data(), false, 1, S_bar.data());
+            if (!Cholesky(nu, R_bar))
+            {
+                return false;
+            }
+            // K = -R_bar^-1*S_bar
+            for (int j = 0; j < nx; j++)
+            {
+                for (int i = 0; i < nu; i++)
+                {
+                    K_[k][i + j * nu] = -S_bar[i + j * nu];
+                }
+                CholeskySolve(nu, L_[k], &K_[k][j * nu]);
+            }
+            if (k == 0)
+            {
+                break;
+            }
+            // P = Q + A'*P*A + S_bar'*K
+            std::vector<double> &P{P_[k]};
+            P = stage.Q;
+            for (int i = 0; i < nx; i++)
+            {
+                P[i + i * nx] += sigma_[k * nx + i];
+            }
+            MatMul(nx, nx, nx, stage.A.data(), true, PA.data(), false, 1, P.data());
+            MatMul(nx, nx, nu, S_bar.data(), true, K_[k].data(), false, 1, P.data());
+            for (int j = 0; j < nx; j++)
+            {
+                for (int i = j + 1; i < nx; i++)
+                {
+                    P[i + j * nx] = P[j + i * nx] = 0.5 * (P[i + j * nx] + P[j + i * nx]);
+                }
+            }
+        }
+        return true;
+    }
+
+    void RiccatiSolver::SolveKKT(const std::vector<RiccatiStage> &stages, const std::vector<double> &grad, const std::vector<double> &res)
+    {
+        const int nx{nx_};
+        const int nu{nu_};
+        const int N{n_stages_};
+        std::vector<double> h(nx);
+        std::vector<double> v(nu);
+        // Backward recursion of the cost-to-go gradients
+        std::copy(&grad[N * nx], &grad[(N + 1) * nx], p_[N].begin());
+        for (int k = N - 1; k >= 0; k--)
+        {
+            const RiccatiStage &stage{stages[k]};
+            // h = P*c + p, v = r + B'*h
+            h = p_[k + 1];
+            MatMul(nx, 1, nx, P_[k + 1].data(), false, &res[k * nx], false, 1, h.data());
+            std::copy(&grad[n_x_ + k * nu], &grad[n_x_ + (k + 1) * nu], v.begin());
+            MatMul(nu, 1, nx, stage.B.data(), true, h.data(), false, 1, v.data());
+            for (int i = 0; i < nu; i++)
+            {
+                k_[k][i] = -v[i];
+            }
+            CholeskySolve(nu, L_[k], k_[k].data());
+            if (k == 0)
+            {
+                break;
+            }
+            // p = q + A'*h + K'*v
+            std::copy(&grad[k * nx], &grad[(k + 1) * nx], p_[k].begin());
+            MatMul(nx, 1, nx, stage.A.data(), true, h.data(), false, 1, p_[k].data());
+            MatMul(nx, 1, nu, K_[k].data(), true, v.data(), false, 1, p_[k].data());
+        }
+        // Forward simulation of the Newton step and the multipliers of the dynamics
+        std::fill(dw_.begin(), dw_.begin() + nx, 0.0);
+        for (int k = 0; k < N; k++)
+        {
+            const RiccatiStage &stage{stages[k]};
+            double *dx_k{&dw_[k * nx]};
+            double *du_k{&dw_[n_x_ + k * nu]};
+            double *dx_next{&dw_[(k + 1) * nx]};
+            std::copy(k_[k].begin(), k_[k].end(), du_k);
+            MatMul(nu, 1, nx, K_[k].data(), false, dx_k, false, 1, du_k);
+            std::copy(&res[k * nx], &res[(k + 1) * nx], dx_next);
+            MatMul(nx, 1, nx, stage.A.data(), false, dx_k, false, 1, dx_next);
+            MatMul(nx, 1, nu, stage.B.data(), false, du_k, false, 1, dx_next);
+            std::copy(p_[k + 1].begin(), p_[k + 1].end(), &pi_new_[k * nx]);
+            MatMul(nx, 1, nx, P_[k + 1].data(), false, dx_next, false, 1, &pi_new_[k * nx]);
+        }
+    }
+
+} // namespace nmpc
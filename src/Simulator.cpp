@@ -1,4 +1,7 @@
-#include <yaml-cpp/yaml.h>
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include "Config.h"
 #include "Simulator.h"
 
 using casadi::DM;
@@ -11,12 +14,76 @@ namespace nmpc
         ReadParams(config_file);
     }
 
+    std::vector<double> Simulator::SimulateBatch(const DM &x_0, const DM &u, int n_steps, const std::vector<ModelScaling> &scaling, const ModelFactory &model_factory) const
+    {
+        const int nx{static_cast<int>(x_0.size1())};
+        const int n_batch{static_cast<int>(x_0.size2())};
+        const int nu{CheckBatchDimensions(x_0, u, n_steps, scaling.size(), static_cast<bool>(model_factory))};
+        std::vector<double> x_data(static_cast<std::size_t>(n_batch) * (n_steps + 1) * nx);
+        if (!pool_)
+        {
+            pool_.reset(new ThreadPool(sim_params_.n_threads));
+        }
+        pool_->ParallelFor(n_batch, [&](int b) {
+            std::unique_ptr<ModelBase<DM>> scaled_model;
+            if (!scaling.empty())
+            {
+                scaled_model = model_factory(scaling[b]);
+            }
+            const ModelBase<DM> &model{scaled_model ? *scaled_model : model_};
+            double *x_b{&x_data[static_cast<std::size_t>(b) * (n_steps + 1) * nx]};
+            DM x_k = x_0(casadi::Slice(), b);
+            for (int k = 0; k <= n_steps; k++)
+            {
+                if (k > 0)
+                {
+                    x_k = integrator_(model, sim_params_.dt, x_k, u(casadi::Slice((k - 1) * nu, k * nu), b));
+                }
+                // Dense copy of the state (structural zeros of the model equations)
+                const std::vector<double> x_k_data(x_k);
+                std::copy(x_k_data.begin(), x_k_data.end(), x_b + k * nx);
+            }
+        });
+        return x_data;
+    }
+
     void Simulator::ReadParams(const std::string &config_file)
     {
-        YAML::Node config = YAML::LoadFile(config_file);
-        sim_params_.t0 = config["sim.t0"].as<double>();
-        sim_params_.dt = config["sim.dt"].as<double>();
-        sim_params_.tf = config["sim.tf"].as<double>();
+        sim_params_ = ReadSimParams(config_file);
+    }
+
+    SimParams ReadSimParams(const std::string &config_file)
+    {
+        SimParams sim_params;
+        const YAML::Node config = LoadConfig(config_file);
+        sim_params.t0 = config["sim.t0"].as<double>();
+        sim_params.dt = config["sim.dt"].as<double>();
+        sim_params.tf = config["sim.tf"].as<double>();
+        sim_params.n_threads = config["sim.batch.n_threads"].as<int>(std::thread::hardware_concurrency());
+        return sim_params;
+    }
+
+    int CheckBatchDimensions(const DM &x_0, const DM &u, int n_steps, std::size_t n_scaling, bool has_model_factory)
+    {
+        const int n_batch{static_cast<int>(x_0.size2())};
+        if (n_steps <= 0)
+        {
+            throw std::invalid_argument("The batch simulation needs at least one step");
+        }
+        if (u.size1() % n_steps != 0 || u.size2() != n_batch)
+        {
+            throw std::invalid_argument("The control sequences of the batch simulation need nu*n_steps rows (n_steps = " + std::to_string(n_steps) +
+                                        ") and one column per initial state (" + std::to_string(n_batch) + ")");
+        }
+        if (n_scaling > 0 && static_cast<int>(n_scaling) != n_batch)
+        {
+            throw std::invalid_argument("The batch simulation needs one model scaling per initial state (" + std::to_string(n_batch) + ")");
+        }
+        if (n_scaling > 0 && !has_model_factory)
+        {
+            throw std::invalid_argument("The model scaling of the batch simulation needs a model factory");
+        }
+        return static_cast<int>(u.size1()) / n_steps;
     }
 
 } // namespace nmpc
\ No newline at end of file
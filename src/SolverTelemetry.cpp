@@ -0,0 +1,284 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "Config.h"
+#include "SolverTelemetry.h"
+
+namespace nmpc
+{
+
+    namespace
+    {
+        // CSV field of a text, quoted (with doubled quotes) if it contains a separator, a quote or a line break
+        std::string CSVField(const char *text)
+        {
+            const std::string field{text};
+            if (field.find_first_of(",\"\r\n") == std::string::npos)
+            {
+                return field;
+            }
+            std::string quoted{"\""};
+            for (char c : field)
+            {
+                quoted += c == '"' ? "\"\"" : std::string(1, c);
+            }
+            return quoted + "\"";
+        }
+
+        // JSON string literal of a text (e.g. a solver error message) with escaped quotes, backslashes and control characters
+        std::string JSONString(const char *text)
+        {
+            std::string literal{"\""};
+            for (const char *c = text; *c != '\0'; c++)
+            {
+                if (*c == '"' || *c == '\\')
+                {
+                    literal += '\\';
+                    literal += *c;
+                }
+                else if (static_cast<unsigned char>(*c) < 0x20)
+                {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(*c));
+                    literal += escaped;
+                }
+                else
+                {
+                    literal += *c;
+                }
+            }
+            return literal + "\"";
+        }
+    } // namespace
+
+    constexpr int SolverTelemetry::n_bins;
+    constexpr int SolverTelemetry::n_words;
+
+    TelemetryParams ReadTelemetryParams(const std::string &config_file)
+    {
+        TelemetryParams telemetry_params;
+        const YAML::Node config = LoadConfig(config_file);
+        telemetry_params.capacity = config["nmpc.telemetry.capacity"].as<int>(4096);
+        telemetry_params.deadline = config["nmpc.telemetry.deadline"].as<double>(0);
+        return telemetry_params;
+    }
+
+    SolverTelemetry::SolverTelemetry(const std::string &config_file) : SolverTelemetry(ReadTelemetryParams(config_file))
+    {
+    }
+
+    SolverTelemetry::SolverTelemetry(const TelemetryParams &telemetry_params)
+        : telemetry_params_(telemetry_params), buffer_(std::max(telemetry_params.capacity, 1)), n_samples_{0}, deadline_misses_{0}, latency_max_{0}, solve_latency_max_{0}
+    {
+        for (int i = 0; i < n_bins; i++)
+        {
+            latency_[i].store(0);
+            solve_latency_[i].store(0);
+        }
+        for (Slot &slot : buffer_)
+        {
+            slot.seq.store(0);
+            for (std::atomic<std::uint64_t> &word : slot.words)
+            {
+                word.store(0);
+            }
+        }
+    }
+
+    SolverTelemetry::SolverTelemetry(const SolverTelemetry &other) : SolverTelemetry(other.telemetry_params_)
+    {
+    }
+
+    void SolverTelemetry::Record(SampleTelemetry sample)
+    {
+        const std::uint64_t i{n_samples_.load(std::memory_order_relaxed)};
+        const double t_total{sample.t_init_wall + sample.t_solve_wall + sample.t_extract_wall};
+        sample.sample = i;
+        sample.deadline_miss = telemetry_params_.deadline > 0 && t_total > telemetry_params_.deadline;
+        // Write the slot between an odd and an even sequence number, the release fence orders the odd sequence number before the words
+        Slot &slot{buffer_[i % buffer_.size()]};
+        std::array<std::uint64_t, n_words> words{};
+        std::memcpy(words.data(), &sample, sizeof(sample));
+        const std::uint64_t seq{slot.seq.load(std::memory_order_relaxed)};
+        slot.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (int w = 0; w < n_words; w++)
+        {
+            slot.words[w].store(words[w], std::memory_order_relaxed);
+        }
+        slot.seq.store(seq + 2, std::memory_order_release);
+        Add(latency_, t_total);
+        Add(solve_latency_, sample.t_solve_wall);
+        latency_max_.store(std::max(latency_max_.load(std::memory_order_relaxed), t_total), std::memory_order_relaxed);
+        solve_latency_max_.store(std::max(solve_latency_max_.load(std::memory_order_relaxed), sample.t_solve_wall), std::memory_order_relaxed);
+        if (sample.deadline_miss)
+        {
+            deadline_misses_.fetch_add(1, std::memory_order_relaxed);
+        }
+        // Publish the sample
+        n_samples_.store(i + 1, std::memory_order_release);
+    }
+
+    std::vector<SampleTelemetry> SolverTelemetry::Samples() const
+    {
+        const std::uint64_t capacity{buffer_.size()};
+        const std::uint64_t n{n_samples_.load(std::memory_order_acquire)};
+        const std::uint64_t first{n > capacity ? n - capacity : 0};
+        std::vector<SampleTelemetry> samples;
+        samples.reserve(n - first);
+        SampleTelemetry sample;
+        for (std::uint64_t i = first; i < n; i++)
+        {
+            // Samples, which the producer overwrites while they are read or has already overwritten with a newer sample, are dropped
+            if (Read(buffer_[i % capacity], sample) && sample.sample == i)
+            {
+                samples.push_back(sample);
+            }
+        }
+        return samples;
+    }
+
+    SampleTelemetry SolverTelemetry::last() const
+    {
+        SampleTelemetry sample{};
+        for (;;)
+        {
+            const std::uint64_t n{n_samples_.load(std::memory_order_acquire)};
+            if (n == 0)
+            {
+                return SampleTelemetry{};
+            }
+            // Retry with the next sample if the producer overwrites the slot in the meantime
+            if (Read(buffer_[(n - 1) % buffer_.size()], sample) && sample.sample == n - 1)
+            {
+                return sample;
+            }
+        }
+    }
+
+    bool SolverTelemetry::Read(const Slot &slot, SampleTelemetry &sample)
+    {
+        // The acquire fence orders the words before the second load of the sequence number, which must be even and unchanged
+        const std::uint64_t seq{slot.seq.load(std::memory_order_acquire)};
+        if (seq % 2 != 0)
+        {
+            return false;
+        }
+        std::array<std::uint64_t, n_words> words;
+        for (int w = 0; w < n_words; w++)
+        {
+            words[w] = slot.words[w].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != seq)
+        {
+            return false;
+        }
+        std::memcpy(&sample, words.data(), sizeof(sample));
+        return true;
+    }
+
+    LatencyPercentiles SolverTelemetry::Latency() const
+    {
+        return Percentiles(latency_, latency_max_.load(std::memory_order_relaxed));
+    }
+
+    LatencyPercentiles SolverTelemetry::SolveLatency() const
+    {
+        return Percentiles(solve_latency_, solve_latency_max_.load(std::memory_order_relaxed));
+    }
+
+    void SolverTelemetry::Add(Histogram &histogram, double t)
+    {
+        const double bin{t > 1e-6 ? std::floor(20 * std::log10(t / 1e-6)) : 0};
+        histogram[static_cast<int>(std::min(bin, n_bins - 1.0))].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    LatencyPercentiles SolverTelemetry::Percentiles(const Histogram &histogram, double max) const
+    {
+        std::array<std::uint64_t, n_bins> counts;
+        std::uint64_t n{0};
+        for (int i = 0; i < n_bins; i++)
+        {
+            counts[i] = histogram[i].load(std::memory_order_relaxed);
+            n += counts[i];
+        }
+        // Upper edge of the bin, which contains the p-quantile
+        auto quantile = [&](double p) {
+            std::uint64_t count{0};
+            for (int i = 0; i < n_bins; i++)
+            {
+                count += counts[i];
+                if (count > 0 && count >= p * n)
+                {
+                    return std::min(1e-6 * std::pow(10, (i + 1) / 20.0), max);
+                }
+            }
+            return max;
+        };
+        return LatencyPercentiles{quantile(0.5), quantile(0.95), quantile(0.99), max};
+    }
+
+    void SolverTelemetry::WriteCSV(const std::string &file_name) const
+    {
+        std::ofstream file(file_name);
+        if (!file)
+        {
+            throw std::runtime_error("Cannot write the telemetry file: " + file_name);
+        }
+        file << "sample,t_init_wall,t_init_cpu,t_solve_wall,t_solve_cpu,t_extract_wall,t_extract_cpu,iter_count,success,return_status,constr_viol,deadline_miss\n";
+        for (const SampleTelemetry &s : Samples())
+        {
+            // The constraint violation is not finite after solver errors (empty field)
+            file << s.sample << "," << s.t_init_wall << "," << s.t_init_cpu << "," << s.t_solve_wall << "," << s.t_solve_cpu << "," << s.t_extract_wall << ","
+                 << s.t_extract_cpu << "," << s.iter_count << "," << s.success << "," << CSVField(s.return_status.data()) << ",";
+            if (std::isfinite(s.constr_viol))
+            {
+                file << s.constr_viol;
+            }
+            file << "," << s.deadline_miss << "\n";
+        }
+    }
+
+    void SolverTelemetry::WriteJSON(const std::string &file_name) const
+    {
+        std::ofstream file(file_name);
+        if (!file)
+        {
+            throw std::runtime_error("Cannot write the telemetry file: " + file_name);
+        }
+        auto write_percentiles = [&file](const LatencyPercentiles &l) {
+            file << "{\"p50\": " << l.p50 << ", \"p95\": " << l.p95 << ", \"p99\": " << l.p99 << ", \"max\": " << l.max << "}";
+        };
+        file << "{\n  \"n_samples\": " << n_samples() << ",\n  \"deadline\": " << telemetry_params_.deadline << ",\n  \"deadline_misses\": " << deadline_misses()
+             << ",\n  \"latency\": ";
+        write_percentiles(Latency());
+        file << ",\n  \"solve_latency\": ";
+        write_percentiles(SolveLatency());
+        file << ",\n  \"samples\": [";
+        const std::vector<SampleTelemetry> samples = Samples();
+        for (std::size_t i = 0; i < samples.size(); i++)
+        {
+            const SampleTelemetry &s{samples[i]};
+            file << (i > 0 ? ",\n    " : "\n    ") << "{\"sample\": " << s.sample << ", \"t_init_wall\": " << s.t_init_wall << ", \"t_init_cpu\": " << s.t_init_cpu
+                 << ", \"t_solve_wall\": " << s.t_solve_wall << ", \"t_solve_cpu\": " << s.t_solve_cpu << ", \"t_extract_wall\": " << s.t_extract_wall
+                 << ", \"t_extract_cpu\": " << s.t_extract_cpu << ", \"iter_count\": " << s.iter_count << ", \"success\": " << (s.success ? "true" : "false")
+                 << ", \"return_status\": " << JSONString(s.return_status.data()) << ", \"constr_viol\": ";
+            // The constraint violation is not finite after solver errors (no JSON number)
+            if (std::isfinite(s.constr_viol))
+            {
+                file << s.constr_viol;
+            }
+            else
+            {
+                file << "null";
+            }
+            file << ", \"deadline_miss\": " << (s.deadline_miss ? "true" : "false") << "}";
+        }
+        file << "\n  ]\n}\n";
+    }
+
+} // namespace nmpc
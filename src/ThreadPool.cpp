@@ -0,0 +1,129 @@
+#include <algorithm>
+#include "ThreadPool.h"
+
+namespace nmpc
+{
+
+    ThreadPool::ThreadPool(int n_threads) : fn_{nullptr}, generation_{0}, n_busy_{0}, stop_{false}
+    {
+        for (int w = 0; w < std::max(n_threads, 1); w++)
+        {
+            queues_.emplace_back(new WorkQueue);
+        }
+        for (int w = 0; w < std::max(n_threads, 1); w++)
+        {
+            workers_.emplace_back(&ThreadPool::WorkerLoop, this, w);
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        loop_started_.notify_all();
+        for (std::thread &worker : workers_)
+        {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::ParallelFor(int n, const std::function<void(int)> &fn)
+    {
+        if (n <= 0)
+        {
+            return;
+        }
+        // Distribute contiguous index ranges over the worker queues, the stealing balances them at run time
+        for (int w = 0; w < n_threads(); w++)
+        {
+            const int begin{static_cast<int>(static_cast<long>(n) * w / n_threads())};
+            const int end{static_cast<int>(static_cast<long>(n) * (w + 1) / n_threads())};
+            std::lock_guard<std::mutex> lock(queues_[w]->mutex);
+            for (int i = begin; i < end; i++)
+            {
+                queues_[w]->indices.push_back(i);
+            }
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        fn_ = &fn;
+        n_busy_ = n_threads();
+        generation_++;
+        loop_started_.notify_all();
+        loop_done_.wait(lock, [this]() { return n_busy_ == 0; });
+        fn_ = nullptr;
+        if (exception_)
+        {
+            std::exception_ptr exception{exception_};
+            exception_ = nullptr;
+            std::rethrow_exception(exception);
+        }
+    }
+
+    bool ThreadPool::NextIndex(int w, int &i)
+    {
+        {
+            std::lock_guard<std::mutex> lock(queues_[w]->mutex);
+            if (!queues_[w]->indices.empty())
+            {
+                i = queues_[w]->indices.front();
+                queues_[w]->indices.pop_front();
+                return true;
+            }
+        }
+        for (int k = 1; k < n_threads(); k++)
+        {
+            WorkQueue &victim{*queues_[(w + k) % n_threads()]};
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.indices.empty())
+            {
+                i = victim.indices.back();
+                victim.indices.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ThreadPool::WorkerLoop(int w)
+    {
+        unsigned long generation{0};
+        while (true)
+        {
+            const std::function<void(int)> *fn;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                loop_started_.wait(lock, [this, generation]() { return stop_ || generation_ != generation; });
+                if (stop_)
+                {
+                    return;
+                }
+                generation = generation_;
+                fn = fn_;
+            }
+            int i;
+            while (NextIndex(w, i))
+            {
+                try
+                {
+                    (*fn)(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (!exception_)
+                    {
+                        exception_ = std::current_exception();
+                    }
+                }
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--n_busy_ == 0)
+            {
+                loop_done_.notify_one();
+            }
+        }
+    }
+
+} // namespace nmpc
@@ -0,0 +1,234 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "Config.h"
+#include "TrajectoryRecorder.h"
+
+using std::string;
+using std::vector;
+
+namespace nmpc
+{
+
+    namespace
+    {
+        // Identifier of the trajectory file format
+        const char file_magic[8] = {'N', 'M', 'P', 'C', 'T', 'R', 'J', '1'};
+        // Length of a column name in the header (including the terminating zero)
+        const std::uint64_t name_size{32};
+
+        std::uint64_t RoundUp(std::uint64_t n, std::uint64_t multiple)
+        {
+            return (n + multiple - 1) / multiple * multiple;
+        }
+
+        [[noreturn]] void ThrowSystemError(const string &what, const string &file_name)
+        {
+            throw std::runtime_error(what + " " + file_name + ": " + std::strerror(errno));
+        }
+    } // namespace
+
+    RecorderParams ReadRecorderParams(const std::string &config_file)
+    {
+        RecorderParams recorder_params;
+        const YAML::Node config = LoadConfig(config_file);
+        recorder_params.block_size = config["recorder.block_size"].as<int>(4096);
+        recorder_params.flush_interval = config["recorder.flush_interval"].as<double>(0.5);
+        return recorder_params;
+    }
+
+    Trajectory ReadTrajectory(const std::string &file_name)
+    {
+        std::ifstream file(file_name, std::ios::binary);
+        char magic[sizeof(file_magic)];
+        std::uint64_t layout[4];
+        if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, file_magic, sizeof(magic)) != 0 || !file.read(reinterpret_cast<char *>(layout), sizeof(layout)))
+        {
+            throw std::runtime_error("No trajectory file: " + file_name);
+        }
+        const std::uint64_t header_size{layout[0]};
+        const std::uint64_t n_columns{layout[1]};
+        const std::uint64_t block_size{layout[2]};
+        const std::uint64_t n_records{layout[3]};
+        Trajectory trajectory;
+        vector<char> name(name_size);
+        for (std::uint64_t c = 0; c < n_columns; c++)
+        {
+            file.read(name.data(), name_size);
+            trajectory.columns.emplace_back(name.data(), strnlen(name.data(), name_size));
+        }
+        // Read the columns block by block
+        trajectory.data.assign(n_columns, vector<double>(n_records));
+        for (std::uint64_t r_0 = 0; r_0 < n_records; r_0 += block_size)
+        {
+            const std::uint64_t n{std::min(block_size, n_records - r_0)};
+            for (std::uint64_t c = 0; c < n_columns; c++)
+            {
+                file.seekg(header_size + (r_0 / block_size * n_columns + c) * block_size * sizeof(double));
+                file.read(reinterpret_cast<char *>(trajectory.data[c].data() + r_0), n * sizeof(double));
+            }
+        }
+        if (!file)
+        {
+            throw std::runtime_error("Incomplete trajectory file: " + file_name);
+        }
+        return trajectory;
+    }
+
+    TrajectoryRecorder::TrajectoryRecorder(const std::string &config_file, const std::string &file_name, const std::vector<std::string> &columns)
+        : TrajectoryRecorder(ReadRecorderParams(config_file), file_name, columns)
+    {
+    }
+
+    TrajectoryRecorder::TrajectoryRecorder(const RecorderParams &recorder_params, const std::string &file_name, const std::vector<std::string> &columns)
+        : file_name_{file_name}, n_columns_{columns.size()}, flush_interval_{recorder_params.flush_interval}, n_blocks_{0}, n_records_{0}, stop_{false}
+    {
+        // The header and the blocks start at page boundaries, so every block can be mapped on its own
+        const std::uint64_t page_size{static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE))};
+        header_size_ = RoundUp(sizeof(Header) + n_columns_ * name_size, page_size);
+        block_size_ = RoundUp(std::max(recorder_params.block_size, 1), page_size / sizeof(double));
+        block_bytes_ = block_size_ * n_columns_ * sizeof(double);
+
+        fd_ = open(file_name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0)
+        {
+            ThrowSystemError("Cannot create the trajectory file", file_name);
+        }
+        // The file is closed and unmapped if it cannot be extended or mapped (or the flush thread cannot be started)
+        header_ = nullptr;
+        try
+        {
+            if (ftruncate(fd_, header_size_) != 0)
+            {
+                ThrowSystemError("Cannot extend the trajectory file", file_name);
+            }
+            void *header{mmap(nullptr, header_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0)};
+            if (header == MAP_FAILED)
+            {
+                ThrowSystemError("Cannot map the trajectory file", file_name);
+            }
+            header_ = static_cast<Header *>(header);
+            std::memcpy(header_->magic, file_magic, sizeof(file_magic));
+            header_->header_size = header_size_;
+            header_->n_columns = n_columns_;
+            header_->block_size = block_size_;
+            header_->n_records = 0;
+            char *names{reinterpret_cast<char *>(header_ + 1)};
+            for (std::uint64_t c = 0; c < n_columns_; c++)
+            {
+                std::strncpy(names + c * name_size, columns[c].c_str(), name_size - 1);
+            }
+            block_ = MapBlock();
+            flusher_ = std::thread(&TrajectoryRecorder::FlushLoop, this);
+        }
+        catch (...)
+        {
+            if (n_blocks_ > 0)
+            {
+                munmap(block_, block_bytes_);
+            }
+            if (header_)
+            {
+                munmap(header_, header_size_);
+            }
+            close(fd_);
+            throw;
+        }
+    }
+
+    TrajectoryRecorder::~TrajectoryRecorder()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        flusher_.join();
+        Flush();
+        msync(block_, block_bytes_, MS_SYNC);
+        munmap(block_, block_bytes_);
+        msync(header_, header_size_, MS_SYNC);
+        munmap(header_, header_size_);
+        close(fd_);
+    }
+
+    void TrajectoryRecorder::Append(const std::vector<double> &record)
+    {
+        const std::uint64_t r{n_records_.load(std::memory_order_relaxed)};
+        const std::uint64_t i{r % block_size_};
+        if (i == 0 && r > 0)
+        {
+            // The full block is handed over to the background thread once the next block is mapped (the current block stays valid if mapping fails)
+            double *block{MapBlock()};
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                finished_.push_back(block_);
+                block_ = block;
+            }
+            cv_.notify_one();
+        }
+        // Missing columns are stored as NaN (no data), not as the zeros of the extended file
+        for (std::uint64_t c = 0; c < n_columns_; c++)
+        {
+            block_[c * block_size_ + i] = c < record.size() ? record[c] : NAN;
+        }
+        n_records_.store(r + 1, std::memory_order_release);
+    }
+
+    double *TrajectoryRecorder::MapBlock()
+    {
+        const std::uint64_t offset{header_size_ + n_blocks_ * block_bytes_};
+        if (ftruncate(fd_, offset + block_bytes_) != 0)
+        {
+            ThrowSystemError("Cannot extend the trajectory file", file_name_);
+        }
+        void *block{mmap(nullptr, block_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, offset)};
+        if (block == MAP_FAILED)
+        {
+            ThrowSystemError("Cannot map the trajectory file", file_name_);
+        }
+        n_blocks_++;
+        return static_cast<double *>(block);
+    }
+
+    void TrajectoryRecorder::FlushLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_)
+        {
+            cv_.wait_for(lock, std::chrono::duration<double>(flush_interval_));
+            lock.unlock();
+            Flush();
+            lock.lock();
+        }
+    }
+
+    void TrajectoryRecorder::Flush()
+    {
+        // The records up to n are complete in the blocks taken here
+        const std::uint64_t n{n_records_.load(std::memory_order_acquire)};
+        vector<double *> finished;
+        double *block;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            finished.swap(finished_);
+            block = block_;
+        }
+        for (double *finished_block : finished)
+        {
+            msync(finished_block, block_bytes_, MS_ASYNC);
+            munmap(finished_block, block_bytes_);
+        }
+        msync(block, block_bytes_, MS_ASYNC);
+        header_->n_records = n;
+        msync(header_, header_size_, MS_ASYNC);
+    }
+
+} // namespace nmpc